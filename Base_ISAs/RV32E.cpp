@@ -1,18 +1,21 @@
 #include "RV32E.h"
 
-RV32E::RV32E(endian_t endian) : RISC_V<word>(16, endian) { base = "RV32E"; }
-
-RV32E::RV32E(endian_t endian, ExtensionList<word> &extension_list) : RISC_V<word>(16, endian, extension_list)
+template <endian_t endian>
+RV32E<endian>::RV32E(memory_backend_t memory_backend) : RISC_V<word, endian>(16, memory_backend)
     { base = "RV32E"; }
 
-RV32E::RV32E(ExtensionList<word> &extension_list) : RISC_V<word>(16, LITTLE, extension_list)
+template <endian_t endian>
+RV32E<endian>::RV32E(ExtensionList<word, endian> &extension_list, memory_backend_t memory_backend)
+    : RISC_V<word, endian>(16, extension_list, memory_backend)
     { base = "RV32E"; }
 
-RV32E::~RV32E() {}
+template <endian_t endian>
+RV32E<endian>::~RV32E() {}
 
-dec_instr_t RV32E::decode()
+template <endian_t endian>
+dec_instr_t RV32E<endian>::decode()
 {
-    dec_instr_t decoded_instruction = RISC_V<word>::decode();
+    dec_instr_t decoded_instruction = RISC_V<word, endian>::decode();
 
     // clear all but the first 4 bits of rd, rs1, and rs2 to ensure x16-x31 are never accessed
     decoded_instruction.rd &= 15;
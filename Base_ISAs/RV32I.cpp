@@ -1,11 +1,13 @@
 #include "RV32I.h"
 
-RV32I::RV32I(endian_t endian) : RISC_V<word>(32, endian) { base = "RV32I"; }
-
-RV32I::RV32I(endian_t endian, ExtensionList<word> &extension_list) : RISC_V<word>(32, endian, extension_list)
+template <endian_t endian>
+RV32I<endian>::RV32I(memory_backend_t memory_backend) : RISC_V<word, endian>(32, memory_backend)
     { base = "RV32I"; }
 
-RV32I::RV32I(ExtensionList<word> &extension_list) : RISC_V<word>(32, LITTLE, extension_list)
+template <endian_t endian>
+RV32I<endian>::RV32I(ExtensionList<word, endian> &extension_list, memory_backend_t memory_backend)
+    : RISC_V<word, endian>(32, extension_list, memory_backend)
     { base = "RV32I"; }
 
-RV32I::~RV32I() {}
\ No newline at end of file
+template <endian_t endian>
+RV32I<endian>::~RV32I() {}
\ No newline at end of file
@@ -3,14 +3,14 @@
 
 #include "../Components/RISC_V.h"
 
-class RV32I : public RISC_V<word>
+template <endian_t endian = LITTLE>
+class RV32I : public RISC_V<word, endian>
 {
-    using RISC_V<word>::base;
+    using RISC_V<word, endian>::base;
     
     public:
-        RV32I(endian_t endian = LITTLE);
-        RV32I(endian_t endian, ExtensionList<word> &extension_list);
-        RV32I(ExtensionList<word> &extension_list);
+        RV32I(memory_backend_t memory_backend = PAGED);
+        RV32I(ExtensionList<word, endian> &extension_list, memory_backend_t memory_backend = PAGED);
         ~RV32I();
 };
 
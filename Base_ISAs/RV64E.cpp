@@ -1,19 +1,21 @@
 #include "RV64E.h"
 
-RV64E::RV64E(endian_t endian) : RISC_V<double_word>(16, endian) 
-    { base = "RV64E"; (*constants)[0xFFFFFFFF] = Register<double_word>(0xFFFFFFFF, true); }
+template <endian_t endian>
+RV64E<endian>::RV64E(memory_backend_t memory_backend) : RISC_V<double_word, endian>(16, memory_backend)
+    { base = "RV64E"; setRV64Handlers(); }
 
-RV64E::RV64E(endian_t endian, ExtensionList<double_word> &extension_list) : RISC_V<double_word>(16, endian, extension_list)
-    { base = "RV64E"; (*constants)[0xFFFFFFFF] = Register<double_word>(0xFFFFFFFF, true); }
+template <endian_t endian>
+RV64E<endian>::RV64E(ExtensionList<double_word, endian> &extension_list, memory_backend_t memory_backend)
+    : RISC_V<double_word, endian>(16, extension_list, memory_backend)
+    { base = "RV64E"; setRV64Handlers(); }
 
-RV64E::RV64E(ExtensionList<double_word> &extension_list) : RISC_V<double_word>(16, LITTLE, extension_list)
-    { base = "RV64E"; (*constants)[0xFFFFFFFF] = Register<double_word>(0xFFFFFFFF, true); }
+template <endian_t endian>
+RV64E<endian>::~RV64E() {}
 
-RV64E::~RV64E() {}
-
-dec_instr_t RV64E::decode()
+template <endian_t endian>
+dec_instr_t RV64E<endian>::decode()
 {    
-    word raw_instruction = ir->read();
+    word raw_instruction = hart.ir;
     byte opcode = raw_instruction & 127;  // retrieve opcode from least significant 7 bits
     dec_instr_t decoded_instruction;  // decoded instruction should be invalid by default
 
@@ -24,15 +26,7 @@ dec_instr_t RV64E::decode()
             // If ARITH_LOG_R_W instruction doesn't exist in Base ISA (likely M instruction), check extensions
             if (decoded_instruction.funct7 != 0 && decoded_instruction.funct7 != 32)
             {
-                decoded_instruction.valid = false;
-                if(extensions != NULL) 
-                {
-                    byte idx = 0;
-                    while(idx < extensions->size() && !decoded_instruction.valid)
-                    {
-                        decoded_instruction = (extensions->at(idx++))->decode();
-                    }
-                }
+                decoded_instruction = decodeFromExtensions();
             }
             break;
         
@@ -42,7 +36,7 @@ dec_instr_t RV64E::decode()
         
         default:
             // if opcode doesn't exist in RV64, check RV32 and extensions
-            decoded_instruction = RISC_V<double_word>::decode();
+            decoded_instruction = RISC_V<double_word, endian>::decode();
             break;
     }
 
@@ -55,237 +49,141 @@ dec_instr_t RV64E::decode()
     return decoded_instruction;
 }
 
-bool RV64E::execute(dec_instr_t instruction)
+template <endian_t endian>
+void RV64E<endian>::setRV64Handlers()
 {
-    // Invalid instructions are obviously not allowed to continue 
-    if (!instruction.valid) {
-        RISC_V<double_word>::setInterruptFlag(II);
-        return false; 
-    }
-
-    // The user program is not allowed to modify the stack pointer
-    if (pc->read() >= program_address_range.start && pc->read() <= program_address_range.end && instruction.rd == 2)
-    {
-        setInterruptFlag(MSP);
-        return false;
-    }
-
-    // Execution was successful if instruction was found and sucessfully executed
-    bool success = true;
-    // count determines if pc should count after instruction is executed (pc should not count if RV32 instruction is executed)
-    bool count = true;
-
-    switch (instruction.opcode)
-    {
-        case ARITH_LOG_R_W:
-            switch(combineFunct(instruction.funct3, instruction.funct7))
-            {
-                case 0b0000000000:  // ADDW
-                    alu->setOperand1(register_set[instruction.rs1].read());     // load rs1's value into ALU
-                    alu->operate(ADD, register_set[instruction.rs2].read());    // perform addition with rs2's value
-                    alu->setOperand1(alu->getResult());                         // load sum into ALU
-                    alu->operate(SXT, constants->at(0x80000000).read());        // sign extend sum by bit 31
-                    register_set[instruction.rd].write(alu->getResult());       // store sign ext'd result into rd
-                    break;
-                
-                case 0b0000100000:  // SUBW
-                    alu->setOperand1(register_set[instruction.rs1].read());     // load rs1's value into ALU
-                    alu->operate(SUB, register_set[instruction.rs2].read());    // perform subtraction with rs2's value
-                    alu->setOperand1(alu->getResult());                         // load difference into ALU
-                    alu->operate(SXT, constants->at(0x80000000).read());        // sign extend sum by bit 31
-                    register_set[instruction.rd].write(alu->getResult());       // store sign ext'd result into rd
-                    break;
-
-                case 0b0010000000:  // SLLW
-                {
-                    // Only shift with the 5 least significant bits of rs2
-                    double_word shamt = register_set[instruction.rs2].read() & 31;  // calculate shift amount
-                    alu->setOperand1(register_set[instruction.rs1].read());         // load rs1's value into ALU
-                    alu->operate(SLL, shamt);                                       // perform logical left shift with rs2's value
-                    alu->setOperand1(alu->getResult());                             // load result into ALU
-                    alu->operate(SXT, constants->at(0x80000000).read());            // sign extend result by bit 31
-                    register_set[instruction.rd].write(alu->getResult());           // store result into rd
-                    break;
-                }
-
-                case 0b1010000000:  // SRLW
-                {
-                    // Only shift with the 5 least significant bits of rs2
-                    double_word shamt = register_set[instruction.rs2].read() & 31;  // calculate shift amount
-                    alu->setOperand1(register_set[instruction.rs1].read());         // load rs1's value into ALU
-                    alu->operate(AND, constants->at(0xFFFFFFFF).read());            // zero extend upper word of rs1's value
-                    alu->setOperand1(alu->getResult());                             // load zero ext'd rs1 into ALU
-                    alu->operate(SRL, shamt);                                       // perform logical right shift with rs2's value
-                    alu->setOperand1(alu->getResult());                             // load result into ALU
-                    alu->operate(SXT, constants->at(0x80000000).read());            // sign extend result by bit 31
-                    register_set[instruction.rd].write(alu->getResult());           // store result into rd
-                    break;
-                }
-
-                case 0b1010100000:  // SRAW
-                {
-                    // Only shift with the 5 least significant bits of rs2
-                    double_word shamt = register_set[instruction.rs2].read() & 31;  // calculate shift amount
-                    alu->setOperand1(register_set[instruction.rs1].read());         // load rs1's value into ALU
-                    alu->operate(SXT, constants->at(0x80000000).read());            // sign extend rs1's value by bit 31
-                    alu->setOperand1(alu->getResult());                             // load sign ext'd rs1 into ALU
-                    alu->operate(SRA, shamt);                                       // perform arithmetic right shift with rs2's value
-                    register_set[instruction.rd].write(alu->getResult());           // store result into rd
-                    break;
-                }
+    // RV32I's instructions stay as the base class set them, since they're the same on RV64
+    setHandler(ARITH_LOG_R_W, 0b000, 0b0000000, static_cast<Handler>(&RV64E::executeADDW));
+    setHandler(ARITH_LOG_R_W, 0b000, 0b0100000, static_cast<Handler>(&RV64E::executeSUBW));
+    setHandler(ARITH_LOG_R_W, 0b001, 0b0000000, static_cast<Handler>(&RV64E::executeSLLW));
+    setHandler(ARITH_LOG_R_W, 0b101, 0b0000000, static_cast<Handler>(&RV64E::executeSRLW));
+    setHandler(ARITH_LOG_R_W, 0b101, 0b0100000, static_cast<Handler>(&RV64E::executeSRAW));
+    setHandler(ARITH_LOG_I_W, 0b000, ANY,       static_cast<Handler>(&RV64E::executeADDIW));
+    setHandler(ARITH_LOG_I_W, 0b001, ANY,       static_cast<Handler>(&RV64E::executeSLLIW));
+    setHandler(ARITH_LOG_I_W, 0b101, ANY,       static_cast<Handler>(&RV64E::executeShiftRightImmediateWord));
+    setHandler(LOAD,          0b011, ANY,       static_cast<Handler>(&RV64E::executeLD));
+    setHandler(LOAD,          0b110, ANY,       static_cast<Handler>(&RV64E::executeLWU));
+    setHandler(STORE,         0b011, ANY,       static_cast<Handler>(&RV64E::executeSD));
+}
 
-                default:
-                    // funct doesn't exist in base ISA; have extensions execute instruction instead
-                    success = executeFromExtensions(instruction);
-                    break;
-            }
-            break;
-        
-        case ARITH_LOG_I_W:
-            switch(instruction.funct3)
-            {
-                case 0b000:  // ADDIW
-                    alu->setOperand1(instruction.imm);                       // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());          // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());  // load rs1's value into ALU
-                    alu->operate(ADD, alu->getResult());                     // perform addition with sign ext'd imm
-                    alu->setOperand1(alu->getResult());                      // load result into ALU
-                    alu->operate(SXT, constants->at(0x80000000).read());     // sign extend result by bit 31
-                    register_set[instruction.rd].write(alu->getResult());    // store result into rd
-                    break;
-                
-                case 0b001:  // SLLIW
-                {
-                    // Only shift with the 5 least significant bits of imm
-                    double_word shamt = instruction.imm & 31;                // calculate shift amount
-                    alu->setOperand1(register_set[instruction.rs1].read());  // load rs1's value into ALU
-                    alu->operate(SLL, shamt);                                // perform logical left shift with imm
-                    alu->setOperand1(alu->getResult());                      // load result into ALU
-                    alu->operate(SXT, constants->at(0x80000000).read());     // sign extend result by bit 31
-                    register_set[instruction.rd].write(alu->getResult());    // store result into rd
-                    break;
-                }
+template <endian_t endian>
+bool RV64E<endian>::executeADDW(dec_instr_t instruction)
+{
+    word result = hart.x[instruction.rs1] + hart.x[instruction.rs2];  // lower word of the sum
+    hart.x[instruction.rd] = (double_word) (s_word) result;           // sign extend result by bit 31
+    return true;
+}
 
-                case 0b101:
-                {
-                    double_word shamt = instruction.imm & 31;                 // calculate shift amount
-                    alu->setOperand1(register_set[instruction.rs1].read());   // load rs1's value into ALU
-                    if(((instruction.imm >> 10) & 1) == 0)  // SRLIW
-                    {
-                        // Only shift with the 5 least significant bits of imm
-                        alu->operate(AND, constants->at(0xFFFFFFFF).read());  // zero extend upper word of rs1's value
-                        alu->setOperand1(alu->getResult());                   // load zero ext'd rs1 into ALU
-                        alu->operate(SRL, shamt);                             // perform logical right shift with imm
-                        alu->setOperand1(alu->getResult());                   // load result into ALU
-                        alu->operate(SXT, constants->at(0x80000000).read());  // sign extend result by bit 31
-                    }
-                    else  // SRAIW
-                    {
-                        // Only shift with the 5 least significant bits of imm
-                        alu->operate(SXT, constants->at(0x80000000).read());  // sign extend rs1's value by bit 31
-                        alu->setOperand1(alu->getResult());                   // load sign ext'd rs1 into ALU
-                        alu->operate(SRA, shamt);                             // perform arithmetic right shift with imm
-                    }         
-                    register_set[instruction.rd].write(alu->getResult());    // store result into rd
-                    break;
-                }
+template <endian_t endian>
+bool RV64E<endian>::executeSUBW(dec_instr_t instruction)
+{
+    word result = hart.x[instruction.rs1] - hart.x[instruction.rs2];  // lower word of the difference
+    hart.x[instruction.rd] = (double_word) (s_word) result;           // sign extend result by bit 31
+    return true;
+}
 
-                default:
-                    // funct doesn't exist in base ISA; have extensions execute instruction instead
-                    success = executeFromExtensions(instruction);
-                    break;
-            }
-            break;
+template <endian_t endian>
+bool RV64E<endian>::executeSLLW(dec_instr_t instruction)
+{
+    word result = (word) hart.x[instruction.rs1] << (hart.x[instruction.rs2] & 31);  // shift by the 5 LS bits of rs2
+    hart.x[instruction.rd] = (double_word) (s_word) result;                          // sign extend result by bit 31
+    return true;
+}
 
-        case LOAD:
-            switch(instruction.funct3)
-            {
-                case 0b011:  // LD
-                    alu->setOperand1(instruction.imm);                         // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());            // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());    // load rs1's value into ALU
-                    alu->operate(ADD, alu->getResult());                       // add rs1's value with sign ext'd imm
-                    // check if user program is attempting to access restricted memory
-                    if ((pc->read() >= program_address_range.start && pc->read() <= program_address_range.end) &&
-                        (alu->getResult() < program_address_range.start || alu->getResult() > program_address_range.end) &&
-                        (alu->getResult() < global_data_address_range.start || alu->getResult() > global_data_address_range.end))
-                    {
-                        setInterruptFlag(SF);
-                    }
-                    else
-                    {
-                        register_set[instruction.rd].write(memory->            // load double word from memory into rd
-                            template getWord<double_word>(alu->getResult()));  // (The RISC-V standard does not require sign extension of the double word)
-                    }
-                    break;
+template <endian_t endian>
+bool RV64E<endian>::executeSRLW(dec_instr_t instruction)
+{
+    word result = (word) hart.x[instruction.rs1] >> (hart.x[instruction.rs2] & 31);  // shift the lower word by the 5 LS bits of rs2
+    hart.x[instruction.rd] = (double_word) (s_word) result;                          // sign extend result by bit 31
+    return true;
+}
 
-                case 0b110:  // LWU
-                    alu->setOperand1(instruction.imm);                         // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());            // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());    // load rs1's value into ALU
-                    alu->operate(ADD, alu->getResult());                       // add rs1's value with sign ext'd imm
-                    // check if user program is attempting to access restricted memory
-                    if ((pc->read() >= program_address_range.start && pc->read() <= program_address_range.end) &&
-                        (alu->getResult() < program_address_range.start || alu->getResult() > program_address_range.end) &&
-                        (alu->getResult() < global_data_address_range.start || alu->getResult() > global_data_address_range.end))
-                    {
-                        setInterruptFlag(SF);
-                    }
-                    else
-                    {
-                        register_set[instruction.rd].write(memory->            // load zero ext'd word from memory into rd
-                            template getWord<word>(alu->getResult()));
-                    }
-                    break;
+template <endian_t endian>
+bool RV64E<endian>::executeSRAW(dec_instr_t instruction)
+{
+    word result = (s_word) hart.x[instruction.rs1] >> (hart.x[instruction.rs2] & 31);  // shift the lower word by the 5 LS bits of rs2
+    hart.x[instruction.rd] = (double_word) (s_word) result;                            // sign extend result by bit 31
+    return true;
+}
 
-                default:
-                    // if load instruction doesn't exist in RV64, execute from RV32
-                    count = false;
-                    success = RISC_V<double_word>::execute(instruction);
-                    break;
-            }
-            break;
+template <endian_t endian>
+bool RV64E<endian>::executeADDIW(dec_instr_t instruction)
+{
+    word result = hart.x[instruction.rs1] + (double_word) instruction.imm;  // lower word of the sum with sign ext'd imm
+    hart.x[instruction.rd] = (double_word) (s_word) result;                 // sign extend result by bit 31
+    return true;
+}
 
-        case STORE:
-            switch(instruction.funct3)
-            {
-                case 0b011:  // SD
-                    alu->setOperand1(instruction.imm);                                 // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());                    // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());            // load rs1's value into ALU
-                    alu->operate(ADD, alu->getResult());                               // add rs1's value with sign ext'd imm
-                    // check if user program is attempting to access restricted memory
-                    if ((pc->read() >= program_address_range.start && pc->read() <= program_address_range.end) &&
-                        (alu->getResult() < program_address_range.start || alu->getResult() > program_address_range.end) &&
-                        (alu->getResult() < global_data_address_range.start || alu->getResult() > global_data_address_range.end))
-                    {
-                        setInterruptFlag(alu->getResult() == 0 ? SAZ : SF);
-                    }
-                    else
-                    {
-                        memory-> template setWord<double_word>                         // store LS double word of rs2's value into memory
-                            (alu->getResult(), register_set[instruction.rs2].read());  
-                    }
-                    break;
-                
-                default:
-                    // if store instruction doesn't exist in RV64, execute from RV32
-                    count = false;
-                    success = RISC_V<double_word>::execute(instruction);
-                    break;
-            }
-            break;
+template <endian_t endian>
+bool RV64E<endian>::executeSLLIW(dec_instr_t instruction)
+{
+    word result = (word) hart.x[instruction.rs1] << (instruction.imm & 31);  // shift by the 5 LS bits of imm
+    hart.x[instruction.rd] = (double_word) (s_word) result;                  // sign extend result by bit 31
+    return true;
+}
 
-        default:
-            // if opcode instruction doesn't exist in RV64, execute from RV32
-            count = false;
-            success = RISC_V<double_word>::execute(instruction);
-            break;
+template <endian_t endian>
+bool RV64E<endian>::executeShiftRightImmediateWord(dec_instr_t instruction)
+{
+    // Only shift with the 5 least significant bits of imm
+    byte shamt = instruction.imm & 31;
+    if(((instruction.imm >> 10) & 1) == 0)  // SRLIW
+    {
+        word result = (word) hart.x[instruction.rs1] >> shamt;
+        hart.x[instruction.rd] = (double_word) (s_word) result;  // sign extend result by bit 31
     }
+    else  // SRAIW
+    {
+        s_word result = (s_word) hart.x[instruction.rs1] >> shamt;
+        hart.x[instruction.rd] = (double_word) result;  // sign extend result by bit 31
+    }
+    return true;
+}
 
-    if(success && count) { pc->count(); }
+template <endian_t endian>
+bool RV64E<endian>::executeLD(dec_instr_t instruction)
+{
+    double_word address = hart.x[instruction.rs1] + (double_word) instruction.imm;  // rs1's value plus imm
+    // check if user program is attempting to access restricted memory
+    if (isRestrictedAccess(address))
+    {
+        setInterruptFlag(SF);
+    }
+    else
+    {
+        hart.x[instruction.rd] = memory-> template load<double_word>(address);  // load double word into rd (no extension is needed)
+    }
+    return true;
+}
 
-    if (!success) { setInterruptFlag(II); }
+template <endian_t endian>
+bool RV64E<endian>::executeLWU(dec_instr_t instruction)
+{
+    double_word address = hart.x[instruction.rs1] + (double_word) instruction.imm;  // rs1's value plus imm
+    // check if user program is attempting to access restricted memory
+    if (isRestrictedAccess(address))
+    {
+        setInterruptFlag(SF);
+    }
+    else
+    {
+        hart.x[instruction.rd] = memory-> template load<word>(address);  // load zero ext'd word into rd
+    }
+    return true;
+}
 
-    return success;
+template <endian_t endian>
+bool RV64E<endian>::executeSD(dec_instr_t instruction)
+{
+    double_word address = hart.x[instruction.rs1] + (double_word) instruction.imm;  // rs1's value plus imm
+    // check if user program is attempting to access restricted memory
+    if (isRestrictedAccess(address))
+    {
+        setInterruptFlag(address == 0 ? SAZ : SF);
+    }
+    else
+    {
+        memory-> template store<double_word>(address, hart.x[instruction.rs2]);  // store rs2's value
+    }
+    return true;
 }
\ No newline at end of file
@@ -3,19 +3,45 @@
 
 #include "../Components/RISC_V.h"
 
-class RV64I : public RISC_V<double_word>
+template <endian_t endian = LITTLE>
+class RV64I : public RISC_V<double_word, endian>
 {
-    using RISC_V<double_word>::base;
+    using RISC_V<double_word, endian>::base;
+    using RISC_V<double_word, endian>::hart;
+    using RISC_V<double_word, endian>::memory;
+    using RISC_V<double_word, endian>::extensions;
+    using RISC_V<double_word, endian>::program_address_range;
+    using RISC_V<double_word, endian>::decodeFromExtensions;
+    using RISC_V<double_word, endian>::executeFromExtensions;
+    using RISC_V<double_word, endian>::isRestrictedAccess;
+    using RISC_V<double_word, endian>::setInterruptFlag;
+    using RISC_V<double_word, endian>::SAZ;
+    using RISC_V<double_word, endian>::SF;
+    using RISC_V<double_word, endian>::MSP;
+    using RISC_V<double_word, endian>::II;
+    using RISC_V<double_word, endian>::ANY;
+    using RISC_V<double_word, endian>::setHandler;
+    typedef typename RISC_V<double_word, endian>::Handler Handler;
     
     public:
-        RV64I(endian_t endian = LITTLE);
-        RV64I(endian_t endian, ExtensionList<double_word> &extension_list);
-        RV64I(ExtensionList<double_word> &extension_list);
+        RV64I(memory_backend_t memory_backend = PAGED);
+        RV64I(ExtensionList<double_word, endian> &extension_list, memory_backend_t memory_backend = PAGED);
         ~RV64I();
     
     private:
         dec_instr_t decode() override;
-        bool execute(dec_instr_t instruction) override;
+        void setRV64Handlers();  // adds the instructions RV64 has on top of RV32I
+        bool executeADDW(dec_instr_t instruction);
+        bool executeSUBW(dec_instr_t instruction);
+        bool executeSLLW(dec_instr_t instruction);
+        bool executeSRLW(dec_instr_t instruction);
+        bool executeSRAW(dec_instr_t instruction);
+        bool executeADDIW(dec_instr_t instruction);
+        bool executeSLLIW(dec_instr_t instruction);
+        bool executeShiftRightImmediateWord(dec_instr_t instruction);
+        bool executeLD(dec_instr_t instruction);
+        bool executeLWU(dec_instr_t instruction);
+        bool executeSD(dec_instr_t instruction);
 };
 
 #endif
\ No newline at end of file
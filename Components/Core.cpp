@@ -0,0 +1,66 @@
+#include "Core.h"
+
+template <typename Base, typename... Ext>
+Core<Base, Ext...>::Core(memory_backend_t memory_backend)
+    : Base(memory_backend), components(this->getComponents()), composed_extensions(Ext(components)...)
+{
+    byte position = 0;
+    std::apply([&](Ext&... extension) { (CPU::claimEncodings(++position, extension.getEncodings()), ...); }, composed_extensions);
+
+    // the handler table is filled in by now, so the entries left to extensions are pointed at them directly
+    Handler composed = static_cast<Handler>(&Core::executeExtensions);
+    for (Handler &handler : handlers)
+    {
+        if (handler == extension_handler) { handler = composed; }
+    }
+    extension_handler = composed;
+}
+
+template <typename Base, typename... Ext>
+Core<Base, Ext...>::~Core() {}
+
+template <typename Base, typename... Ext>
+dec_instr_t Core<Base, Ext...>::decodeFromExtensions()
+{
+    dec_instr_t decoded_instruction;  // stays invalid if no extension decodes the instruction
+    decoding_extension = NULL;
+    byte owner = CPU::findOwner(components.hart->ir);
+    byte position = 0;
+    std::apply([&](Ext&... extension) { ((++position == owner && decodeWith(extension, decoded_instruction)) || ...); },
+               composed_extensions);
+    return decoded_instruction;
+}
+
+template <typename Base, typename... Ext>
+std::string Core<Base, Ext...>::describeExtensions()
+{
+    if (sizeof...(Ext) == 0) { return "None"; }
+    std::string names;
+    std::apply([&](Ext&... extension) { ((names += extension.getName() + " "), ...); }, composed_extensions);
+    return names;
+}
+
+template <typename Base, typename... Ext>
+bool Core<Base, Ext...>::executeExtensions(dec_instr_t instruction)
+{
+    bool executed = std::apply([&](Ext&... extension)
+        { return ((decoding_extension == &extension && executeWith(extension, instruction)) || ...); }, composed_extensions);
+    if (!executed) { CPU::setInterruptFlag(CPU::II); }
+    return executed;
+}
+
+template <typename Base, typename... Ext>
+template <typename E>
+bool Core<Base, Ext...>::decodeWith(E &extension, dec_instr_t &decoded_instruction)
+{
+    decoded_instruction = extension.E::decode();  // qualified, so it isn't looked up in the vtable
+    if (decoded_instruction.valid) { decoding_extension = &extension; }
+    return decoded_instruction.valid;
+}
+
+template <typename Base, typename... Ext>
+template <typename E>
+bool Core<Base, Ext...>::executeWith(E &extension, const dec_instr_t &instruction)
+{
+    return extension.E::execute(instruction);  // qualified, so it isn't looked up in the vtable
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef CORE_H
+#define CORE_H
+
+#include <tuple>
+#include <string>
+#include "RISC_V.h"
+
+// A CPU whose extensions are fixed when it's compiled, such as Core<RV32I<>, M<>> for RV32IM. The extensions are held by
+// value and called directly (not through their vtables), so the compiler can inline them into the handler that runs every
+// instruction the base ISA doesn't have. Of them, only the one that owns an instruction's encoding is asked to decode it,
+// and only the one that decoded it to execute it. The base ISAs with an ExtensionList stay the way to choose extensions at
+// runtime.
+template <typename Base, typename... Ext>
+class Core final : public Base
+{
+    typedef typename Base::word_type word_size;
+    static constexpr endian_t endian = Base::byte_order;
+    typedef RISC_V<word_size, endian> CPU;  // the base ISAs may hide what they use of it, so it's named directly
+    typedef typename CPU::Handler Handler;
+    using CPU::handlers;
+    using CPU::extension_handler;
+    using CPU::decoding_extension;
+
+    static_assert((std::is_base_of<Extension<word_size, endian>, Ext>::value && ...),
+                  "extensions must be as wide and have the same byte order as the base ISA");
+
+    public:
+        Core(memory_backend_t memory_backend = PAGED);
+        ~Core();
+
+    private:
+        // what the extensions are constructed with: members are initialized once Base is, so its hart and memory exist by
+        // then, and this one is declared (so initialized) before the extensions that take it
+        RISC_V_Components<word_size, endian> components;
+        std::tuple<Ext...> composed_extensions;  // in the order they're asked to decode and execute
+
+        dec_instr_t decodeFromExtensions() override;
+        std::string describeExtensions() override;
+        bool executeExtensions(dec_instr_t instruction);  // handler of everything the base ISA doesn't have
+        template <typename E>
+            bool decodeWith(E &extension, dec_instr_t &decoded_instruction);  // false if extension doesn't decode it
+        template <typename E>
+            bool executeWith(E &extension, const dec_instr_t &instruction);  // false if extension doesn't execute it
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "DecodeCache.h"
+
+template <typename word_size, endian_t endian>
+DecodeCache<word_size, endian>::DecodeCache(Memory<word_size, endian> *memory) : memory(memory), last_page_number(0), last_page(NULL)
+{
+    memory->setWriteWatcher(this);
+}
+
+template <typename word_size, endian_t endian>
+DecodeCache<word_size, endian>::~DecodeCache()
+{
+    memory->setWriteWatcher(NULL);
+    clear();
+    collectDroppedBlocks();
+}
+
+template <typename word_size, endian_t endian>
+PackedInstruction<word_size, endian>* DecodeCache<word_size, endian>::find(word_size address)
+{
+    if((address & (sizeof(word) - 1)) != 0) { return NULL; }  // misaligned instructions could span two pages
+
+    word_size page_number = address >> Memory<word_size, endian>::PAGE_BITS;
+    if(last_page == NULL || last_page_number != page_number)
+    {
+        PackedInstruction<word_size, endian> *&page = pages[page_number];
+        if(page == NULL)
+        {
+            page = new PackedInstruction<word_size, endian>[ENTRIES_PER_PAGE]();
+            memory->watchPage(page_number);
+        }
+        last_page_number = page_number;
+        last_page = page;
+    }
+    return &last_page[(address & Memory<word_size, endian>::PAGE_MASK) / sizeof(word)];
+}
+
+template <typename word_size, endian_t endian>
+void DecodeCache<word_size, endian>::pageWritten(word_size page_number)
+{
+    auto entry = pages.find(page_number);
+    if(entry == pages.end()) { return; }
+    if(entry->second == last_page) { last_page = NULL; }
+    delete [] entry->second;
+    pages.erase(entry);
+
+    // blocks elsewhere may be linked to the page's blocks, so every link is cut
+    if(blocks.empty()) { return; }
+    for(auto block = blocks.begin(); block != blocks.end();)
+    {
+        if((block->first >> Memory<word_size, endian>::PAGE_BITS) == page_number)
+        {
+            dropped_blocks.push_back(block->second);
+            block = blocks.erase(block);
+        }
+        else
+        {
+            block->second->links[0].block = NULL;
+            block->second->links[1].block = NULL;
+            block++;
+        }
+    }
+}
+
+template <typename word_size, endian_t endian>
+void DecodeCache<word_size, endian>::clear()
+{
+    for(auto &entry : pages) { delete [] entry.second; }
+    pages.clear();
+    last_page = NULL;
+    for(auto &entry : blocks) { dropped_blocks.push_back(entry.second); }
+    blocks.clear();
+}
+
+template <typename word_size, endian_t endian>
+BasicBlock<word_size, endian>* DecodeCache<word_size, endian>::findBlock(word_size address)
+{
+    auto entry = blocks.find(address);
+    return (entry != blocks.end()) ? entry->second : NULL;
+}
+
+template <typename word_size, endian_t endian>
+void DecodeCache<word_size, endian>::addBlock(BasicBlock<word_size, endian> *block) { blocks[block->start] = block; }
+
+template <typename word_size, endian_t endian>
+bool DecodeCache<word_size, endian>::blocksDropped() { return !dropped_blocks.empty(); }
+
+template <typename word_size, endian_t endian>
+void DecodeCache<word_size, endian>::collectDroppedBlocks()
+{
+    for(BasicBlock<word_size, endian> *block : dropped_blocks) { delete block; }
+    dropped_blocks.clear();
+}
+
+template <typename word_size, endian_t endian>
+word DecodeCache<word_size, endian>::countEntry(word_size address) { return ++entry_counts[address]; }
+
+template <typename word_size, endian_t endian>
+PackedInstruction<word_size, endian> DecodeCache<word_size, endian>::pack(dec_instr_t instruction, word raw_instruction,
+                                                                          Extension<word_size, endian> *extension)
+{
+    return {extension, raw_instruction, (word) instruction.imm, instruction.opcode, instruction.rd, instruction.rs1, instruction.rs2,
+            instruction.funct3, instruction.funct7, instruction.valid, true};
+}
+
+template <typename word_size, endian_t endian>
+dec_instr_t DecodeCache<word_size, endian>::unpack(const PackedInstruction<word_size, endian> &entry)
+{
+    dec_instr_t instruction;
+    instruction.valid = entry.valid;
+    instruction.opcode = entry.opcode;
+    instruction.imm = (double_word) (s_word) entry.imm;
+    instruction.rd = entry.rd;
+    instruction.rs1 = entry.rs1;
+    instruction.rs2 = entry.rs2;
+    instruction.funct3 = entry.funct3;
+    instruction.funct7 = entry.funct7;
+    return instruction;
+}
\ No newline at end of file
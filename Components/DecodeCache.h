@@ -0,0 +1,91 @@
+#ifndef DECODE_CACHE_H
+#define DECODE_CACHE_H
+
+#include <unordered_map>
+#include <vector>
+#include "../Utilities/DataTypes.h"
+#include "Memory.h"
+#include "../Extensions/Extension.h"
+
+template <typename word_size, endian_t endian>
+class RISC_V;
+
+template <typename word_size = word, endian_t endian = LITTLE>
+struct PackedInstruction  // a decoded instruction as it's cached, along with its raw word for the instruction register
+{
+    Extension<word_size, endian> *extension;  // extension that decoded the instruction (NULL for the base ISA)
+    word raw_instruction;
+    word imm;  // lower word of the sign ext'd immediate (unpack() extends it again)
+    byte opcode;
+    byte rd;
+    byte rs1;
+    byte rs2;
+    byte funct3;
+    byte funct7;
+    bool valid;
+    bool filled;  // false until the instruction at the entry's address is decoded
+};
+
+template <typename word_size = word, endian_t endian = LITTLE>
+struct BlockInstruction  // an instruction of a basic block, ready to execute
+{
+    dec_instr_t instruction;
+    word raw_instruction;
+    Extension<word_size, endian> *extension;  // extension that decoded the instruction (NULL for the base ISA)
+    bool (RISC_V<word_size, endian>::*handler)(dec_instr_t instruction);  // what runs it, looked up when the block is formed
+};
+
+typedef word (*NativeCode)();  // a block translated into host code, which returns how many of its instructions it ran
+
+template <typename word_size = word, endian_t endian = LITTLE>
+struct BasicBlock  // straight-line instructions on one page, ending with the first one that can jump
+{
+    struct Link  // a successor that's run without looking it up (NULL block if there's none yet)
+    {
+        word_size address;
+        BasicBlock *block;
+    };
+
+    word_size start;
+    std::vector<BlockInstruction<word_size, endian>> instructions;
+    Link links[2];  // the block that falls through from this one, and the last other block it jumped to
+    word executions;  // times the block was entered, which decides when it's worth translating
+    NativeCode native_code;  // NULL until the block is translated
+};
+
+// Decoded instructions by address, one array of entries per page of code, and the basic blocks formed from them. Memory
+// reports the first write to each cached page, which drops the whole page and its blocks so they're decoded again.
+template <typename word_size = word, endian_t endian = LITTLE>
+class DecodeCache : public WriteWatcher<word_size>
+{
+    public:
+        DecodeCache(Memory<word_size, endian> *memory);
+        ~DecodeCache();
+        PackedInstruction<word_size, endian>* find(word_size address);  // returns NULL for addresses that aren't word aligned
+        void pageWritten(word_size page_number) override;
+        void clear();
+
+        // Basic blocks by start address (a dropped block is freed by the next collect, so a running block can finish its
+        // instruction)
+        BasicBlock<word_size, endian>* findBlock(word_size address);  // returns NULL if no block starts at address
+        void addBlock(BasicBlock<word_size, endian> *block);
+        bool blocksDropped();  // returns true if any block was dropped since the last collect
+        void collectDroppedBlocks();
+        word countEntry(word_size address);  // counts another time a block's start was reached before the block was formed
+
+        static PackedInstruction<word_size, endian> pack(dec_instr_t instruction, word raw_instruction, Extension<word_size, endian> *extension);
+        static dec_instr_t unpack(const PackedInstruction<word_size, endian> &entry);
+
+        static constexpr word_size ENTRIES_PER_PAGE = Memory<word_size, endian>::PAGE_SIZE / sizeof(word);
+
+    private:
+        Memory<word_size, endian> *memory;
+        std::unordered_map<word_size, PackedInstruction<word_size, endian>*> pages;  // by page number
+        word_size last_page_number;  // page of the last instruction found, which is almost always the next one's too
+        PackedInstruction<word_size, endian> *last_page;  // NULL if it was dropped
+        std::unordered_map<word_size, BasicBlock<word_size, endian>*> blocks;  // by start address
+        std::vector<BasicBlock<word_size, endian>*> dropped_blocks;  // freed by the next collect
+        std::unordered_map<word_size, word> entry_counts;  // by start address (kept when pages are dropped, since the code stays as hot)
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,7 @@
+#include "Device.h"
+
+template <typename address_size>
+Device<address_size>::~Device() {}
+
+template <typename address_size>
+address_size Device<address_size>::peek(address_size address, byte *data, address_size size) { return read(address, data, size); }
\ No newline at end of file
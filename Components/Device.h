@@ -0,0 +1,18 @@
+#ifndef DEVICE_H
+#define DEVICE_H
+
+#include "../Utilities/DataTypes.h"
+
+// A memory-mapped device. Accesses start at an address inside the range the device was attached to and hold their bytes
+// in address order. Each returns how many of those bytes the device handled, and memory handles the rest.
+template <typename address_size = word>
+class Device
+{
+    public:
+        virtual ~Device();
+        virtual address_size read(address_size address, byte *data, address_size size) = 0;
+        virtual address_size write(address_size address, const byte *data, address_size size) = 0;
+        virtual address_size peek(address_size address, byte *data, address_size size);  // read without side effects
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,20 @@
+#ifndef HART_STATE_H
+#define HART_STATE_H
+
+#include "../Utilities/DataTypes.h"
+
+// Everything a hart's instructions read and write, kept in one block that starts on a cache line. Execution, extensions,
+// the debugger, snapshots, and translated code all work on it directly. Decoding sends writes to x0 to the sink slot, so x0
+// stays zero without instructions checking for it.
+template <typename word_size = word>
+struct alignas(64) HartState
+{
+    static constexpr byte SINK = 32;  // index of the slot that writes to x0 go to
+
+    word_size x[33];        // x0-x31, then the sink
+    word_size pc;           // program counter
+    word ir;                // instruction register
+    byte interrupt_flags;   // pending interrupt and exception flags, which programs see at address 1
+};
+
+#endif
\ No newline at end of file
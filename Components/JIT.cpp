@@ -0,0 +1,438 @@
+#include "JIT.h"
+#include <cstddef>
+#include <string.h>
+#include <sys/mman.h>
+#include "../Utilities/CombineFunct.h"
+
+template <typename word_size, endian_t endian>
+JIT<word_size, endian>::JIT(NativeContext<word_size> context) : context(context), buffer(NULL), buffer_used(0), full(false),
+    last_instruction(0)
+{
+    if (!isSupported()) { return; }
+    void *mapping = mmap(NULL, BUFFER_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) { perror("Error mapping memory for translated code"); }
+    else { buffer = (byte*) mapping; }
+}
+
+template <typename word_size, endian_t endian>
+JIT<word_size, endian>::~JIT() { if (buffer != NULL) { munmap(buffer, BUFFER_SIZE); } }
+
+template <typename word_size, endian_t endian>
+bool JIT<word_size, endian>::isSupported()
+{
+#if defined(__x86_64__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+template <typename word_size, endian_t endian>
+bool JIT<word_size, endian>::isAvailable() { return buffer != NULL; }
+
+template <typename word_size, endian_t endian>
+bool JIT<word_size, endian>::isFull() { return full; }
+
+template <typename word_size, endian_t endian>
+void JIT<word_size, endian>::reset()
+{
+    buffer_used = 0;
+    full = false;
+}
+
+template <typename word_size, endian_t endian>
+NativeCode JIT<word_size, endian>::compile(const BasicBlock<word_size, endian> &block)
+{
+    if (buffer == NULL || full) { return NULL; }
+
+    code.clear();
+    emitByte(0x53);  // push rbx (which also aligns the stack for calls)
+    emitREX(true, 0, RBX);  // movabs rbx, hart state
+    emitByte(0xB8 + RBX);
+    emitDoubleWord((double_word) context.hart);
+
+    word count = 0;
+    bool jumped = false;  // the last instruction translated wrote pc itself
+    for (const BlockInstruction<word_size, endian> &block_instruction : block.instructions)
+    {
+        if (!translate(block_instruction, block.start + count * sizeof(word), count)) { break; }
+        byte opcode = block_instruction.instruction.opcode;
+        jumped = (opcode == BRANCH || opcode == JAL || opcode == JALR);
+        count++;
+    }
+    if (count == 0) { return NULL; }
+
+    // the interpreter carries on from the first instruction that wasn't translated
+    last_instruction = block.instructions[count - 1].raw_instruction;
+    if (!jumped)
+    {
+        moveImmediate(RAX, block.start + count * sizeof(word));
+        writePC(RAX);
+    }
+    exit(count);
+
+    if (buffer_used + code.size() > BUFFER_SIZE)
+    {
+        full = true;
+        return NULL;
+    }
+    memcpy(buffer + buffer_used, code.data(), code.size());
+    NativeCode native_code = (NativeCode) (buffer + buffer_used);
+    buffer_used = (buffer_used + code.size() + 15) & ~(double_word) 15;  // blocks start on 16-byte boundaries
+    return native_code;
+}
+
+template <typename word_size, endian_t endian>
+bool JIT<word_size, endian>::translate(const BlockInstruction<word_size, endian> &block_instruction, word_size address, word count)
+{
+    const dec_instr_t &instruction = block_instruction.instruction;
+    if (!instruction.valid) { return false; }
+    // writing the stack pointer from the user program raises an exception, which the interpreter handles
+    if (instruction.rd == 2 && address >= context.program_address_range.start && address <= context.program_address_range.end)
+    {
+        return false;
+    }
+
+    constexpr bool wide = sizeof(word_size) > 4;
+    bool multiplication = block_instruction.extension != NULL && block_instruction.extension->isStandardM();
+    last_instruction = block_instruction.raw_instruction;
+
+    switch (instruction.opcode)
+    {
+        case ARITH_LOG_R:
+        case ARITH_LOG_R_W:
+        {
+            bool word_operation = instruction.opcode == ARITH_LOG_R_W;  // RV64's 32-bit operations
+            half_word funct = combineFunct(instruction.funct3, instruction.funct7);
+            switch (funct)
+            {
+                case 0b0000000000:  // ADD
+                case 0b0000100000:  // SUB
+                case 0b0010000000:  // SLL
+                case 0b1010000000:  // SRL
+                case 0b1010100000:  // SRA
+                    if (word_operation && !wide) { return false; }
+                    break;
+
+                case 0b0100000000:  // SLT
+                case 0b0110000000:  // SLTU
+                case 0b1000000000:  // XOR
+                case 0b1100000000:  // OR
+                case 0b1110000000:  // AND
+                    if (word_operation) { return false; }
+                    break;
+
+                case 0b0000000001:  // MUL
+                    if (!multiplication || (word_operation && !wide)) { return false; }
+                    break;
+
+                default:
+                    return false;
+            }
+
+            bool operation_wide = wide && !word_operation;
+            loadRegister(RAX, instruction.rs1);
+            loadRegister(RCX, instruction.rs2);
+            switch (funct)
+            {
+                case 0b0000000000: operate(0x01, RAX, RCX, operation_wide); break;  // add
+                case 0b0000100000: operate(0x29, RAX, RCX, operation_wide); break;  // sub
+                case 0b0010000000: shift(4, RAX, operation_wide); break;            // shl (by the low bits of cl, like RISC-V)
+                case 0b1010000000: shift(5, RAX, operation_wide); break;            // shr
+                case 0b1010100000: shift(7, RAX, operation_wide); break;            // sar
+                case 0b1000000000: operate(0x31, RAX, RCX); break;                  // xor
+                case 0b1100000000: operate(0x09, RAX, RCX); break;                  // or
+                case 0b1110000000: operate(0x21, RAX, RCX); break;                  // and
+                case 0b0100000000:                                                  // cmp, setl
+                    operate(0x39, RAX, RCX);
+                    setCondition(LESS);
+                    break;
+                case 0b0110000000:                                                  // cmp, setb
+                    operate(0x39, RAX, RCX);
+                    setCondition(BELOW);
+                    break;
+                case 0b0000000001:                                                  // imul
+                    emitREX(operation_wide, RAX, RCX);
+                    emitByte(0x0F);
+                    emitByte(0xAF);
+                    emitByte(0xC0 | (RAX << 3) | RCX);
+                    break;
+            }
+            if (word_operation) { signExtendWord(); }
+            storeRegister(instruction.rd, RAX);
+            return true;
+        }
+
+        case ARITH_LOG_I:
+        case ARITH_LOG_I_W:
+        {
+            bool word_operation = instruction.opcode == ARITH_LOG_I_W;
+            if (word_operation && (!wide || (instruction.funct3 != 0b000 && instruction.funct3 != 0b001 && instruction.funct3 != 0b101)))
+            {
+                return false;
+            }
+
+            bool operation_wide = wide && !word_operation;
+            s_word immediate = (s_word) instruction.imm;
+            byte shift_amount = instruction.imm & (word_operation ? 31 : sizeof(word_size) * 8 - 1);
+            loadRegister(RAX, instruction.rs1);
+            switch (instruction.funct3)
+            {
+                case 0b000: operateImmediate(0, RAX, immediate, operation_wide); break;                   // ADDI
+                case 0b001: shiftImmediate(4, RAX, shift_amount, operation_wide); break;                  // SLLI
+                case 0b010:                                                                              // SLTI
+                    operateImmediate(7, RAX, immediate);
+                    setCondition(LESS);
+                    break;
+                case 0b011:                                                                              // SLTIU
+                    operateImmediate(7, RAX, immediate);
+                    setCondition(BELOW);
+                    break;
+                case 0b100: operateImmediate(6, RAX, immediate); break;                                   // XORI
+                case 0b101: shiftImmediate(((instruction.imm >> 10) & 1) ? 7 : 5, RAX, shift_amount, operation_wide); break;  // SRAI, SRLI
+                case 0b110: operateImmediate(1, RAX, immediate); break;                                   // ORI
+                case 0b111: operateImmediate(4, RAX, immediate); break;                                   // ANDI
+            }
+            if (word_operation) { signExtendWord(); }
+            storeRegister(instruction.rd, RAX);
+            return true;
+        }
+
+        case LUI:
+            moveImmediate(RAX, (word_size) instruction.imm);
+            storeRegister(instruction.rd, RAX);
+            return true;
+
+        case AUIPC:
+            moveImmediate(RAX, address + (word_size) instruction.imm);
+            storeRegister(instruction.rd, RAX);
+            return true;
+
+        case LOAD:
+            return translateLoad(instruction, address, block_instruction.raw_instruction, count);
+
+        case STORE:
+            return translateStore(instruction, address, block_instruction.raw_instruction, count);
+
+        case BRANCH:
+        {
+            condition_t conditions[8] = {EQUAL, NOT_EQUAL, EQUAL, EQUAL, LESS, GREATER_EQUAL, BELOW, ABOVE_EQUAL};
+            if (instruction.funct3 == 0b010 || instruction.funct3 == 0b011) { return false; }
+
+            // pc = (rs1 compared with rs2) ? target : next instruction
+            loadRegister(RAX, instruction.rs1);
+            loadRegister(RCX, instruction.rs2);
+            operate(0x39, RAX, RCX);
+            moveImmediate(RAX, address + sizeof(word));
+            moveImmediate(RDX, address + (word_size) instruction.imm);
+            emitREX(wide, RAX, RDX);  // cmovcc rax, rdx
+            emitByte(0x0F);
+            emitByte(0x40 + conditions[instruction.funct3]);
+            emitByte(0xC0 | (RAX << 3) | RDX);
+            writePC(RAX);
+            return true;
+        }
+
+        case JAL:
+            moveImmediate(RAX, address + sizeof(word));
+            storeRegister(instruction.rd, RAX);
+            moveImmediate(RAX, address + (word_size) instruction.imm);
+            writePC(RAX);
+            return true;
+
+        case JALR:
+            if (instruction.funct3 != 0b000) { return false; }
+            // the target is read before rd is written, since they may be the same register
+            loadRegister(RAX, instruction.rs1);
+            operateImmediate(0, RAX, (s_word) instruction.imm & ~1);
+            moveImmediate(RCX, address + sizeof(word));
+            storeRegister(instruction.rd, RCX);
+            writePC(RAX);
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+template <typename word_size, endian_t endian>
+bool JIT<word_size, endian>::translateLoad(const dec_instr_t &instruction, word_size address, word raw_instruction, word count)
+{
+    NativeAccess<word_size> access = context.loads[instruction.funct3];
+    if (access == NULL) { return false; }
+
+    loadRegister(RCX, instruction.rs1);
+    operateImmediate(0, RCX, (s_word) instruction.imm);
+    moveImmediate(R8, instruction.rd);
+    callAccess(access, address, raw_instruction, count);
+    return true;
+}
+
+template <typename word_size, endian_t endian>
+bool JIT<word_size, endian>::translateStore(const dec_instr_t &instruction, word_size address, word raw_instruction, word count)
+{
+    NativeAccess<word_size> access = context.stores[instruction.funct3];
+    if (access == NULL) { return false; }
+
+    loadRegister(RCX, instruction.rs1);
+    operateImmediate(0, RCX, (s_word) instruction.imm);
+    loadRegister(R8, instruction.rs2);
+    callAccess(access, address, raw_instruction, count);
+    return true;
+}
+
+template <typename word_size, endian_t endian>
+void JIT<word_size, endian>::emitByte(byte value) { code.push_back(value); }
+
+template <typename word_size, endian_t endian>
+void JIT<word_size, endian>::emitWord(word value)
+{
+    for (byte i = 0; i < 4; i++) { emitByte(value >> (8 * i)); }  // x86 immediates are little-endian
+}
+
+template <typename word_size, endian_t endian>
+void JIT<word_size, endian>::emitDoubleWord(double_word value)
+{
+    emitWord(value);
+    emitWord(value >> 32);
+}
+
+template <typename word_size, endian_t endian>
+void JIT<word_size, endian>::emitREX(bool wide, byte reg, byte rm)
+{
+    byte rex = 0x40 | (wide ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0);
+    if (rex != 0x40) { emitByte(rex); }
+}
+
+template <typename word_size, endian_t endian>
+void JIT<word_size, endian>::loadRegister(host_register_t host_register, byte guest_register)
+{
+    // mov host register, [rbx + offset of the guest register's value]
+    word offset = offsetof(HartState<word_size>, x) + guest_register * sizeof(word_size);
+    emitREX(sizeof(word_size) > 4, host_register, RBX);
+    emitByte(0x8B);
+    emitByte(0x80 | ((host_register & 7) << 3) | RBX);
+    emitWord(offset);
+}
+
+template <typename word_size, endian_t endian>
+void JIT<word_size, endian>::storeRegister(byte guest_register, host_register_t host_register)
+{
+    if (guest_register == 0) { return; }  // x0 is hardcoded to zero
+
+    // mov [rbx + offset of the guest register's value], host register
+    word offset = offsetof(HartState<word_size>, x) + guest_register * sizeof(word_size);
+    emitREX(sizeof(word_size) > 4, host_register, RBX);
+    emitByte(0x89);
+    emitByte(0x80 | ((host_register & 7) << 3) | RBX);
+    emitWord(offset);
+}
+
+template <typename word_size, endian_t endian>
+void JIT<word_size, endian>::moveImmediate(host_register_t host_register, word_size value, bool wide)
+{
+    emitREX(wide, 0, host_register);  // mov host register, immediate
+    emitByte(0xB8 + (host_register & 7));
+    if (wide) { emitDoubleWord(value); }
+    else { emitWord(value); }
+}
+
+template <typename word_size, endian_t endian>
+void JIT<word_size, endian>::operate(byte opcode, host_register_t destination, host_register_t source, bool wide)
+{
+    emitREX(wide, source, destination);
+    emitByte(opcode);
+    emitByte(0xC0 | ((source & 7) << 3) | (destination & 7));
+}
+
+template <typename word_size, endian_t endian>
+void JIT<word_size, endian>::operateImmediate(byte extension, host_register_t destination, s_word immediate, bool wide)
+{
+    emitREX(wide, 0, destination);  // the immediate is sign extended to 64 bits
+    emitByte(0x81);
+    emitByte(0xC0 | (extension << 3) | (destination & 7));
+    emitWord(immediate);
+}
+
+template <typename word_size, endian_t endian>
+void JIT<word_size, endian>::shift(byte extension, host_register_t destination, bool wide)
+{
+    emitREX(wide, 0, destination);
+    emitByte(0xD3);
+    emitByte(0xC0 | (extension << 3) | (destination & 7));
+}
+
+template <typename word_size, endian_t endian>
+void JIT<word_size, endian>::shiftImmediate(byte extension, host_register_t destination, byte amount, bool wide)
+{
+    emitREX(wide, 0, destination);
+    emitByte(0xC1);
+    emitByte(0xC0 | (extension << 3) | (destination & 7));
+    emitByte(amount);
+}
+
+template <typename word_size, endian_t endian>
+void JIT<word_size, endian>::setCondition(condition_t condition)
+{
+    emitByte(0x0F);  // setcc al
+    emitByte(0x90 + condition);
+    emitByte(0xC0);
+    emitByte(0x0F);  // movzx eax, al
+    emitByte(0xB6);
+    emitByte(0xC0);
+}
+
+template <typename word_size, endian_t endian>
+void JIT<word_size, endian>::signExtendWord()
+{
+    emitByte(0x48);  // movsxd rax, eax
+    emitByte(0x63);
+    emitByte(0xC0);
+}
+
+template <typename word_size, endian_t endian>
+void JIT<word_size, endian>::writePC(host_register_t host_register)
+{
+    emitREX(sizeof(word_size) > 4, host_register, RBX);  // mov [rbx + offset of pc], host register
+    emitByte(0x89);
+    emitByte(0x80 | ((host_register & 7) << 3) | RBX);
+    emitWord(offsetof(HartState<word_size>, pc));
+}
+
+template <typename word_size, endian_t endian>
+void JIT<word_size, endian>::callAccess(NativeAccess<word_size> access, word_size address, word raw_instruction, word count)
+{
+    // access(cpu, address, raw instruction, rcx, r8)
+    emitREX(true, 0, RDI);
+    emitByte(0xB8 + RDI);
+    emitDoubleWord((double_word) context.cpu);
+    moveImmediate(RSI, address);
+    moveImmediate(RDX, raw_instruction, false);
+    emitREX(true, 0, RAX);
+    emitByte(0xB8 + RAX);
+    emitDoubleWord((double_word) access);
+    emitByte(0xFF);  // call rax
+    emitByte(0xD0);
+
+    // test al, al and jz past an exit that counts the access's instruction as run
+    emitByte(0x84);
+    emitByte(0xC0);
+    emitByte(0x74);
+    size_t jump = code.size();
+    emitByte(0);
+    exit(count + 1);
+    code[jump] = code.size() - (jump + 1);
+}
+
+template <typename word_size, endian_t endian>
+void JIT<word_size, endian>::exit(word count)
+{
+    emitByte(0xC7);  // mov dword [rbx + offset of the instruction register], raw word of the last instruction
+    emitByte(0x80 | RBX);
+    emitWord(offsetof(HartState<word_size>, ir));
+    emitWord(last_instruction);
+    emitByte(0xB8 + RAX);  // mov eax, count
+    emitWord(count);
+    emitByte(0x5B);  // pop rbx
+    emitByte(0xC3);  // ret
+}
\ No newline at end of file
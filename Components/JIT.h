@@ -0,0 +1,94 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <vector>
+#include "../Utilities/DataTypes.h"
+#include "HartState.h"
+#include "DecodeCache.h"
+
+// A C++ function translated code calls to load or store for one instruction. It's given the CPU, the instruction's address
+// and raw word, the address to access, and the destination register (loads) or the value to store (stores), and returns
+// true if the block has to stop after the instruction.
+template <typename word_size = word>
+using NativeAccess = bool (*)(void *cpu, word_size instruction_address, word raw_instruction, word_size address, word_size operand);
+
+template <typename word_size = word>
+struct NativeContext  // the CPU state translated code works on
+{
+    HartState<word_size> *hart;  // registers, pc, and instruction register
+    void *cpu;  // passed to the access functions
+    NativeAccess<word_size> loads[8];  // by funct3 (NULL for loads that are left to the interpreter)
+    NativeAccess<word_size> stores[8];  // by funct3 (NULL for stores that are left to the interpreter)
+    AddressRange<word_size> program_address_range;  // instructions there mustn't write the stack pointer
+};
+
+// Translates basic blocks of RV32I or RV64I instructions (and M's multiplications) into x86-64 code. Guest registers stay
+// in the CPU's hart state, and loads and stores go through the CPU, so translated code can stop after any of them.
+// Translation stops at the first instruction it doesn't support, which the interpreter runs along with the rest of the block.
+template <typename word_size = word, endian_t endian = LITTLE>
+class JIT
+{
+    public:
+        JIT(NativeContext<word_size> context);
+        ~JIT();
+        static bool isSupported();  // false unless the host is x86-64
+        bool isAvailable();  // false if executable memory couldn't be mapped
+        NativeCode compile(const BasicBlock<word_size, endian> &block);  // returns NULL if nothing was translated
+        bool isFull();  // true once a block didn't fit in the buffer
+        void reset();  // empties the buffer, so none of the code translated so far may run again
+
+        static constexpr double_word BUFFER_SIZE = 1 << 24;  // 16 MiB of host code
+
+    private:
+        typedef enum
+        {
+            RAX = 0,
+            RCX = 1,
+            RDX = 2,
+            RBX = 3,  // holds the address of the hart state
+            RSI = 6,
+            RDI = 7,
+            R8  = 8
+        } host_register_t;
+
+        typedef enum  // condition codes of jcc, setcc, and cmovcc
+        {
+            BELOW         = 0x2,
+            ABOVE_EQUAL   = 0x3,
+            EQUAL         = 0x4,
+            NOT_EQUAL     = 0x5,
+            LESS          = 0xC,
+            GREATER_EQUAL = 0xD
+        } condition_t;
+
+        bool translate(const BlockInstruction<word_size, endian> &block_instruction, word_size address, word count);  // false if unsupported
+        bool translateLoad(const dec_instr_t &instruction, word_size address, word raw_instruction, word count);
+        bool translateStore(const dec_instr_t &instruction, word_size address, word raw_instruction, word count);
+
+        // x86-64 encodings (operations are as wide as word_size unless they're 32-bit, and host registers are as above)
+        void emitByte(byte value);
+        void emitWord(word value);
+        void emitDoubleWord(double_word value);
+        void emitREX(bool wide, byte reg, byte rm);  // only emitted if needed
+        void loadRegister(host_register_t host_register, byte guest_register);
+        void storeRegister(byte guest_register, host_register_t host_register);  // writes to x0 are dropped
+        void moveImmediate(host_register_t host_register, word_size value, bool wide = sizeof(word_size) > 4);
+        void operate(byte opcode, host_register_t destination, host_register_t source, bool wide = sizeof(word_size) > 4);
+        void operateImmediate(byte extension, host_register_t destination, s_word immediate, bool wide = sizeof(word_size) > 4);
+        void shift(byte extension, host_register_t destination, bool wide = sizeof(word_size) > 4);  // by cl
+        void shiftImmediate(byte extension, host_register_t destination, byte amount, bool wide = sizeof(word_size) > 4);
+        void setCondition(condition_t condition);  // rax = 1 if the condition holds, and 0 otherwise
+        void signExtendWord();  // rax = eax sign extended
+        void writePC(host_register_t host_register);
+        void callAccess(NativeAccess<word_size> access, word_size address, word raw_instruction, word count);  // stops the block if told to
+        void exit(word count);  // writes the instruction register and returns count
+
+        NativeContext<word_size> context;
+        byte *buffer;  // NULL if executable memory couldn't be mapped
+        double_word buffer_used;
+        bool full;
+        std::vector<byte> code;  // the block being translated
+        word last_instruction;  // raw word of the last instruction translated, which the instruction register holds on exit
+};
+
+#endif
\ No newline at end of file
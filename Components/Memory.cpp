@@ -1,47 +1,1019 @@
 #include "Memory.h"
+#include <unordered_set>
+#include <algorithm>
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <signal.h>
+#include <unistd.h>
 
-template<typename address_size>
-Memory<address_size>::Memory() : endian(LITTLE) { RAM = new std::unordered_map<address_size, byte>(); }
+// Guarded loads and stores that fault are redirected to the recovery point of the memory currently running
+static sigjmp_buf *guard_recovery_point = NULL;
+static byte *guarded_view_start = NULL;
+static byte *guarded_view_end = NULL;
 
-template<typename address_size>
-Memory<address_size>::Memory(endian_t endian) : endian(endian) { RAM = new std::unordered_map<address_size, byte>(); }
+static void handleGuardFault(int signal_number, siginfo_t *info, void *)
+{
+    byte *fault_address = (byte*) info->si_addr;
+    if(guard_recovery_point != NULL && fault_address >= guarded_view_start && fault_address < guarded_view_end)
+    {
+        siglongjmp(*guard_recovery_point, 1);  // abandon the faulting load or store
+    }
+    signal(signal_number, SIG_DFL);  // any other fault is a genuine crash once the handler returns
+}
+
+template<typename address_size, endian_t endian>
+Memory<address_size, endian>::Memory(memory_backend_t backend) : RAM(NULL), directory(NULL),
+    radix_root(NULL), address_space(NULL), guarded_space(NULL), guest_space(NULL), memory_file(-1), io_bitmap(NULL),
+    sparse_io_bitmap(NULL), snapshot_RAM(NULL), snapshot_pages(NULL), dirty_bitmap(NULL), sparse_dirty_bitmap(NULL),
+    every_page_dirty(false), write_watcher(NULL), watch_bitmap(NULL), sparse_watch_bitmap(NULL), page_counters(NULL), backend(backend)
+{
+    if(backend == MAPPED || backend == GUARDED)
+    {
+        // reserve the entire guest address space; the kernel only commits the pages that are touched
+        if(sizeof(address_size) <= 4)
+        {
+            if(backend == GUARDED) { mapGuardedAddressSpace(); }
+            if(address_space == NULL)
+            {
+                byte *reservation = reserveAddressSpace(ADDRESS_SPACE_SIZE);
+                if(reservation != NULL && mprotect(reservation, ADDRESS_SPACE_SIZE, PROT_READ | PROT_WRITE) == 0)
+                {
+                    address_space = reservation;
+                }
+                else
+                {
+                    perror("Error reserving guest address space");
+                    if(reservation != NULL) { munmap(reservation, ADDRESS_SPACE_SIZE); }
+                }
+            }
+        }
+        this->backend = (address_space != NULL) ? MAPPED : PAGED;  // 64-bit address spaces can't be reserved whole
+    }
+
+    switch(this->backend)
+    {
+        case HASHED:
+            RAM = new std::unordered_map<address_size, byte>();
+            break;
+
+        case PAGED:
+            if(sizeof(address_size) <= 4) { directory = new PageTable*[1 << DIRECTORY_BITS](); }
+            else { radix_root = new RadixNode[1](); }
+            break;
 
-template<typename address_size>
-Memory<address_size>::~Memory(){ delete RAM; }
+        case MAPPED:
+        case GUARDED:
+            break;
+    }
+    flushTLB();
+}
 
-template<typename address_size>
-void Memory<address_size>::clear()
+template<typename address_size, endian_t endian>
+Memory<address_size, endian>::~Memory()
 {
+    discardSnapshot();
+    freePages();
     delete RAM;
-    RAM = new std::unordered_map<address_size, byte>();
+    delete [] directory;
+    delete [] radix_root;
+    if(address_space != NULL) { munmap(address_space, ADDRESS_SPACE_SIZE); }
+    if(guarded_space != NULL)
+    {
+        if(guarded_view_start == guarded_space) { setRecoveryPoint(NULL); }
+        munmap(guarded_space, ADDRESS_SPACE_SIZE + PAGE_SIZE);
+    }
+    if(memory_file != -1) { close(memory_file); }
+    delete [] io_bitmap;
+    delete sparse_io_bitmap;
+    delete [] watch_bitmap;
+    delete sparse_watch_bitmap;
+    delete page_counters;
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::clear()
+{
+    reportAllWrites();
+    every_page_dirty = true;
+    switch(backend)
+    {
+        case HASHED:
+            delete RAM;
+            RAM = new std::unordered_map<address_size, byte>();
+            break;
+
+        case PAGED:
+            freePages();
+            break;
+
+        case MAPPED:
+        case GUARDED:
+            // touched pages are released and read back as zero (shared memory must be removed from its file instead)
+            madvise(address_space, ADDRESS_SPACE_SIZE, (guarded_space == NULL) ? MADV_DONTNEED : MADV_REMOVE);
+            break;
+    }
+}
+
+template<typename address_size, endian_t endian>
+typename Memory<address_size, endian>::PageTable*& Memory<address_size, endian>::getTableSlot(address_size table_index)
+{
+    if(radix_root == NULL) { return directory[table_index]; }
+
+    TableCacheEntry &entry = table_cache[table_index & (TABLE_CACHE_SIZE - 1)];
+    if(entry.slot != NULL && entry.table_index == table_index) { return *entry.slot; }
+
+    // each level is indexed by the next RADIX_BITS of the table index, from the top
+    RadixNode *node = radix_root;
+    for(byte level = RADIX_LEVELS - 1; level > 0; level--)
+    {
+        void *&child = (*node)[(table_index >> (level * RADIX_BITS)) & (RADIX_SIZE - 1)];
+        if(child == NULL) { child = new RadixNode[1](); }
+        node = (RadixNode*) child;
+    }
+    PageTable **slot = (PageTable**) &(*node)[table_index & (RADIX_SIZE - 1)];
+    entry = {table_index, slot};
+    return *slot;
+}
+
+template<typename address_size, endian_t endian>
+typename Memory<address_size, endian>::PageTable* Memory<address_size, endian>::findTable(address_size table_index) const
+{
+    if(radix_root == NULL) { return directory[table_index]; }
+
+    const TableCacheEntry &entry = table_cache[table_index & (TABLE_CACHE_SIZE - 1)];
+    if(entry.slot != NULL && entry.table_index == table_index) { return *entry.slot; }
+
+    const RadixNode *node = radix_root;
+    for(byte level = RADIX_LEVELS - 1; level > 0; level--)
+    {
+        node = (const RadixNode*) (*node)[(table_index >> (level * RADIX_BITS)) & (RADIX_SIZE - 1)];
+        if(node == NULL) { return NULL; }
+    }
+    return (PageTable*) (*node)[table_index & (RADIX_SIZE - 1)];
+}
+
+template<typename address_size, endian_t endian>
+template<typename Visit>
+void Memory<address_size, endian>::forEachTable(Visit visit)
+{
+    if(directory != NULL)
+    {
+        for(address_size i = 0; i < ((address_size) 1 << DIRECTORY_BITS); i++) { visit(i, directory[i]); }
+    }
+    if(radix_root != NULL) { visitRadixNode(radix_root, RADIX_LEVELS - 1, 0, visit); }
+}
+
+template<typename address_size, endian_t endian>
+template<typename Visit>
+void Memory<address_size, endian>::visitRadixNode(RadixNode *node, byte level, address_size table_index, Visit &visit)
+{
+    for(address_size i = 0; i < RADIX_SIZE; i++)
+    {
+        if((*node)[i] == NULL) { continue; }
+        address_size child_index = table_index | (i << (level * RADIX_BITS));
+        if(level > 0) { visitRadixNode((RadixNode*) (*node)[i], level - 1, child_index, visit); }
+        else { visit(child_index, *(PageTable**) &(*node)[i]); }
+    }
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::freeRadixNode(RadixNode *node, byte level)
+{
+    for(address_size i = 0; i < RADIX_SIZE; i++)
+    {
+        if((*node)[i] == NULL) { continue; }
+        if(level > 0)
+        {
+            freeRadixNode((RadixNode*) (*node)[i], level - 1);
+            delete [] (RadixNode*) (*node)[i];
+        }
+        (*node)[i] = NULL;
+    }
+}
+
+template<typename address_size, endian_t endian>
+byte*& Memory<address_size, endian>::getPageSlot(address_size address)
+{
+    PageTable *&table = getTableSlot(address >> (PAGE_BITS + TABLE_BITS));
+    if(table == NULL) { table = new PageTable[1](); }
+    return (*table)[(address >> PAGE_BITS) & (TABLE_SIZE - 1)];
+}
+
+template<typename address_size, endian_t endian>
+byte* Memory<address_size, endian>::getPage(address_size address, bool write)
+{
+    byte *&page = getPageSlot(address);
+    if(page == NULL) { page = new byte[PAGE_SIZE](); }  // pages are zeroed on first touch
+    else if(write && isShared(address >> PAGE_BITS, page))
+    {
+        // copy on write, so the snapshot keeps the page as it was
+        byte *copy = new byte[PAGE_SIZE];
+        memcpy(copy, page, PAGE_SIZE);
+        page = copy;
+
+        TLBEntry &read_entry = read_tlb[(address >> PAGE_BITS) & (TLB_SIZE - 1)];
+        if(read_entry.page != NULL && read_entry.page_number == address >> PAGE_BITS) { read_entry.page = page; }
+    }
+    return page;
+}
+
+template<typename address_size, endian_t endian>
+bool Memory<address_size, endian>::isShared(address_size page_number, const byte *page) const
+{
+    if(snapshot_pages == NULL || backend != PAGED) { return false; }
+    auto entry = snapshot_pages->find(page_number);
+    return entry != snapshot_pages->end() && entry->second == page;
+}
+
+template<typename address_size, endian_t endian>
+const byte* Memory<address_size, endian>::findPage(address_size address) const
+{
+    const PageTable *table = findTable(address >> (PAGE_BITS + TABLE_BITS));
+    return (table != NULL) ? (*table)[(address >> PAGE_BITS) & (TABLE_SIZE - 1)] : NULL;
+}
+
+template<typename address_size, endian_t endian>
+byte* Memory<address_size, endian>::translate(address_size address, bool write)
+{
+    // the TLB is direct-mapped; read and write entries are kept apart so a page can be cached for reading only
+    address_size page_number = address >> PAGE_BITS;
+    TLBEntry &entry = (write ? write_tlb : read_tlb)[page_number & (TLB_SIZE - 1)];
+    if(entry.page != NULL && entry.page_number == page_number)
+    {
+        write ? tlb_statistics.write_hits++ : tlb_statistics.read_hits++;
+        return entry.page;
+    }
+
+    write ? tlb_statistics.write_misses++ : tlb_statistics.read_misses++;
+    if(write) { markDirty(address); }  // pages are only written through the TLB after a write miss
+    if(isIOPage(page_number)) { return NULL; }  // I/O pages are never cached, so every access to them can reach their devices
+    entry.page_number = page_number;
+    entry.page = getPage(address, write);
+    return entry.page;
+}
+
+template<typename address_size, endian_t endian>
+byte* Memory<address_size, endian>::getContiguous(address_size address, address_size size, bool write)
+{
+    switch(backend)
+    {
+        case PAGED:
+            if((address & PAGE_MASK) <= PAGE_SIZE - size)
+            {
+                // I/O pages aren't cached, but the memory around their devices is still contiguous
+                byte *page = translate(address, write);
+                if(page == NULL && !overlapsDevice(address, size)) { page = getPage(address, write); }
+                if(page != NULL) { return page + (address & PAGE_MASK); }
+            }
+            break;
+
+        case MAPPED:
+        case GUARDED:
+            if(address <= (address_size) (0 - size)  // the access mustn't wrap around
+               && ((!isIOPage(address >> PAGE_BITS) && !isIOPage((address + size - 1) >> PAGE_BITS)) || !overlapsDevice(address, size)))
+            {
+                if(write)
+                {
+                    markDirty(address);
+                    markDirty(address + size - 1);
+                }
+                return address_space + address;
+            }
+            break;
+
+        default:
+            break;
+    }
+    return NULL;
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::flushTLB()
+{
+    for(address_size i = 0; i < TLB_SIZE; i++)
+    {
+        read_tlb[i] = {0, NULL};
+        write_tlb[i] = {0, NULL};
+    }
+    for(address_size i = 0; i < TABLE_CACHE_SIZE; i++) { table_cache[i] = {0, NULL}; }
+}
+
+template<typename address_size, endian_t endian>
+TLBStatistics Memory<address_size, endian>::getTLBStatistics() { return tlb_statistics; }
+
+template<typename address_size, endian_t endian>
+constexpr endian_t Memory<address_size, endian>::getEndian() { return endian; }
+
+template<typename address_size, endian_t endian>
+memory_backend_t Memory<address_size, endian>::getBackend() { return backend; }
+
+template<typename address_size, endian_t endian>
+double_word Memory<address_size, endian>::getResidentPages() { return getResidentPages({0, (address_size) -1}); }
+
+template<typename address_size, endian_t endian>
+double_word Memory<address_size, endian>::getResidentPages(AddressRange<address_size> range)
+{
+    address_size first_page = range.start >> PAGE_BITS;
+    address_size last_page = range.end >> PAGE_BITS;
+    double_word pages = 0;
+    switch(backend)
+    {
+        case HASHED:
+        {
+            // every byte is a separate entry, so the pages are the distinct pages the stored bytes fall in
+            std::unordered_set<address_size> touched_pages;
+            for(auto &entry : *RAM)
+            {
+                address_size page_number = entry.first >> PAGE_BITS;
+                if(page_number >= first_page && page_number <= last_page) { touched_pages.insert(page_number); }
+            }
+            pages = touched_pages.size();
+            break;
+        }
+
+        case PAGED:
+        {
+            forEachTable([&](address_size table_index, PageTable *table)
+            {
+                if(table == NULL) { return; }
+                for(address_size i = 0; i < TABLE_SIZE; i++)
+                {
+                    address_size page_number = (table_index << TABLE_BITS) | i;
+                    if((*table)[i] != NULL && page_number >= first_page && page_number <= last_page) { pages++; }
+                }
+            });
+            break;
+        }
+
+        case MAPPED:
+        case GUARDED:
+        {
+            // the kernel knows which pages of the mapping it has committed
+            double_word count = (double_word) last_page - first_page + 1;
+            std::vector<unsigned char> resident(count);
+            if(mincore(address_space + ((double_word) first_page << PAGE_BITS), count << PAGE_BITS, resident.data()) == -1)
+            {
+                perror("Error finding resident guest memory");
+                break;
+            }
+            for(unsigned char page : resident) { pages += page & 1; }
+            break;
+        }
+    }
+    return pages;
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::setPageCounting(bool counting)
+{
+    delete page_counters;
+    page_counters = counting ? new std::unordered_map<address_size, PageCounters>() : NULL;
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::countAccess(address_size address, bool write)
+{
+    if(page_counters == NULL) { return; }
+    PageCounters &counters = (*page_counters)[address >> PAGE_BITS];
+    write ? counters.writes++ : counters.reads++;
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::dumpStatistics(FILE *file)
+{
+    const char *backend_names[] = {"HASHED", "PAGED", "MAPPED", "GUARDED"};
+    double_word resident_pages = getResidentPages();
+    fprintf(file, "Memory backend: %s%s\n", backend_names[backend], (guarded_space != NULL) ? " (guarded)" : "");
+    fprintf(file, "Resident memory: %llu pages (%llu bytes)\n", resident_pages, resident_pages << PAGE_BITS);
+    if(snapshot_pages != NULL) { fprintf(file, "Snapshot pages: %llu\n", (double_word) snapshot_pages->size()); }
+    if(dirty_bitmap != NULL || sparse_dirty_bitmap != NULL)
+    {
+        fprintf(file, "Pages written since snapshot: %llu\n", (double_word) dirty_pages.size());
+    }
+    if(backend == PAGED)
+    {
+        fprintf(file, "TLB reads: %llu hits, %llu misses\n", tlb_statistics.read_hits, tlb_statistics.read_misses);
+        fprintf(file, "TLB writes: %llu hits, %llu misses\n", tlb_statistics.write_hits, tlb_statistics.write_misses);
+    }
+
+    if(page_counters == NULL) { return; }
+
+    // hottest pages first
+    std::vector<std::pair<address_size, PageCounters>> pages(page_counters->begin(), page_counters->end());
+    std::sort(pages.begin(), pages.end(), [](const std::pair<address_size, PageCounters> &a,
+                                             const std::pair<address_size, PageCounters> &b)
+    {
+        return a.second.reads + a.second.writes > b.second.reads + b.second.writes;
+    });
+    fprintf(file, "\n%-*s  %20s  %20s\n", (int) sizeof(address_size) * 2, "Page", "Reads", "Writes");
+    for(auto &page : pages)
+    {
+        fprintf(file, "%0*llX  %20llu  %20llu\n", (int) sizeof(address_size) * 2, (double_word) page.first << PAGE_BITS,
+                page.second.reads, page.second.writes);
+    }
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::mapGuardedAddressSpace()
+{
+    // both views map the same memory file, so a page guarded in one view stays accessible through the other
+    int file = memfd_create("guest_memory", 0);
+    if(file == -1 || ftruncate(file, ADDRESS_SPACE_SIZE) == -1)
+    {
+        perror("Error creating guarded guest memory");
+        if(file != -1) { close(file); }
+        return;
+    }
+
+    void *unguarded_view = reserveAddressSpace(ADDRESS_SPACE_SIZE);
+    if(unguarded_view == NULL) { unguarded_view = MAP_FAILED; }
+    else if(mmap(unguarded_view, ADDRESS_SPACE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_NORESERVE | MAP_FIXED, file, 0) == MAP_FAILED)
+    {
+        munmap(unguarded_view, ADDRESS_SPACE_SIZE);
+        unguarded_view = MAP_FAILED;
+    }
+    // the guarded view is followed by an inaccessible page so accesses that wrap around the address space fault too
+    void *guarded_view = reserveAddressSpace(ADDRESS_SPACE_SIZE + PAGE_SIZE);
+    if(guarded_view == NULL) { guarded_view = MAP_FAILED; }
+    else if(mmap(guarded_view, ADDRESS_SPACE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_NORESERVE | MAP_FIXED, file, 0) == MAP_FAILED)
+    {
+        munmap(guarded_view, ADDRESS_SPACE_SIZE + PAGE_SIZE);
+        guarded_view = MAP_FAILED;
+    }
+
+    if(unguarded_view == MAP_FAILED || guarded_view == MAP_FAILED)
+    {
+        perror("Error mapping guarded guest memory");
+        if(unguarded_view != MAP_FAILED) { munmap(unguarded_view, ADDRESS_SPACE_SIZE); }
+        if(guarded_view != MAP_FAILED) { munmap(guarded_view, ADDRESS_SPACE_SIZE + PAGE_SIZE); }
+        close(file);
+        return;
+    }
+    memory_file = file;  // kept open so peeks can read holes without allocating them
+    address_space = (byte*) unguarded_view;
+    guest_space = guarded_space = (byte*) guarded_view;
+}
+
+template<typename address_size, endian_t endian>
+byte* Memory<address_size, endian>::reserveAddressSpace(double_word size)
+{
+    // over-reserve by a huge page and trim the ends, so guest addresses aligned to a huge page are aligned on the host too
+    void *mapping = mmap(NULL, size + HUGE_PAGE_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(mapping == MAP_FAILED) { return NULL; }
+    byte *start = (byte*) mapping;
+    byte *aligned = (byte*) (((uintptr_t) start + HUGE_PAGE_SIZE - 1) & ~(uintptr_t) (HUGE_PAGE_SIZE - 1));
+    if(aligned != start) { munmap(start, aligned - start); }
+    munmap(aligned + size, start + HUGE_PAGE_SIZE - aligned);
+    return aligned;
+}
+
+template<typename address_size, endian_t endian>
+bool Memory<address_size, endian>::setHugePages(AddressRange<address_size> range, bool huge)
+{
+    if(address_space == NULL) { return false; }  // HASHED and PAGED memory is allocated a page at a time
+
+    // only the huge pages lying entirely inside the range can be backed by one, but every page it touches can opt out
+    double_word start = huge ? (((double_word) range.start + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1))
+                             : (range.start & ~(double_word) PAGE_MASK);
+    double_word end = huge ? (((double_word) range.end + 1) & ~(HUGE_PAGE_SIZE - 1))
+                           : (((double_word) range.end + PAGE_SIZE) & ~(double_word) PAGE_MASK);
+    if(start >= end) { return false; }
+
+    // the advice fails on hosts without transparent huge pages, and memory keeps using regular pages
+    int advice = huge ? MADV_HUGEPAGE : MADV_NOHUGEPAGE;
+    bool advised = madvise(address_space + start, end - start, advice) == 0;
+    if(guarded_space != NULL) { advised = madvise(guarded_space + start, end - start, advice) == 0 && advised; }
+    return advised;
+}
+
+template<typename address_size, endian_t endian>
+bool Memory<address_size, endian>::isGuarded() { return guarded_space != NULL; }
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::guardRange(AddressRange<address_size> range, bool guarded)
+{
+    if(guarded_space == NULL) { return; }
+
+    // guarding covers every page the range touches, but unguarding only frees the pages that lie entirely inside it
+    double_word first_page = guarded ? (range.start >> PAGE_BITS) : (((double_word) range.start + PAGE_MASK) >> PAGE_BITS);
+    double_word end_page = guarded ? ((range.end >> PAGE_BITS) + 1) : (((double_word) range.end + 1) >> PAGE_BITS);
+    if(first_page >= end_page) { return; }
+    mprotect(guarded_space + (first_page << PAGE_BITS), (end_page - first_page) << PAGE_BITS,
+             guarded ? PROT_NONE : PROT_READ | PROT_WRITE);
+    if(!guarded) { guardIOPages(); }  // guest loads and stores must never reach I/O pages directly
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::attachDevice(AddressRange<address_size> range, Device<address_size> *device)
+{
+    devices.push_back({range, device});
+    markIOPages(range);
+    flushTLB();
+    guardIOPages();
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::detachDevice(Device<address_size> *device)
+{
+    for(auto mapped_device = devices.begin(); mapped_device != devices.end();)
+    {
+        if(mapped_device->device == device) { mapped_device = devices.erase(mapped_device); }
+        else { mapped_device++; }
+    }
+
+    // the pages of the remaining devices are marked again (detached pages stay guarded, which only makes them slower)
+    if(io_bitmap != NULL) { memset(io_bitmap, 0, ((double_word) 1 << (32 - PAGE_BITS)) / 8); }
+    if(sparse_io_bitmap != NULL) { sparse_io_bitmap->clear(); }
+    for(MappedDevice &mapped_device : devices) { markIOPages(mapped_device.range); }
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::markIOPages(AddressRange<address_size> range)
+{
+    if(sizeof(address_size) <= 4 && io_bitmap == NULL) { io_bitmap = new double_word[((double_word) 1 << (32 - PAGE_BITS)) / 64](); }
+    if(sizeof(address_size) > 4 && sparse_io_bitmap == NULL) { sparse_io_bitmap = new std::unordered_map<address_size, double_word>(); }
+
+    for(address_size page_number = range.start >> PAGE_BITS; ; page_number++)
+    {
+        double_word bit = (double_word) 1 << (page_number & 63);
+        if(io_bitmap != NULL) { io_bitmap[page_number >> 6] |= bit; }
+        else { (*sparse_io_bitmap)[page_number >> 6] |= bit; }
+        if(page_number == range.end >> PAGE_BITS) { break; }
+    }
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::guardIOPages()
+{
+    if(guarded_space == NULL) { return; }
+    for(MappedDevice &mapped_device : devices)
+    {
+        double_word first_page = mapped_device.range.start >> PAGE_BITS;
+        double_word end_page = (mapped_device.range.end >> PAGE_BITS) + 1;
+        mprotect(guarded_space + (first_page << PAGE_BITS), (end_page - first_page) << PAGE_BITS, PROT_NONE);
+    }
+}
+
+template<typename address_size, endian_t endian>
+bool Memory<address_size, endian>::isIOPage(address_size page_number) const
+{
+    if(io_bitmap != NULL) { return (io_bitmap[page_number >> 6] >> (page_number & 63)) & 1; }
+    if(sparse_io_bitmap == NULL) { return false; }
+    auto entry = sparse_io_bitmap->find(page_number >> 6);
+    return entry != sparse_io_bitmap->end() && ((entry->second >> (page_number & 63)) & 1);
 }
 
-template<typename address_size>
-byte Memory<address_size>::getByte(address_size address)
+template<typename address_size, endian_t endian>
+bool Memory<address_size, endian>::overlapsDevice(address_size address, address_size size) const
 {
-    if(RAM->count(address) == 0) { (*RAM)[address] = 0; }
-    return RAM->at(address);
+    for(const MappedDevice &mapped_device : devices)
+    {
+        if(address <= mapped_device.range.end && address + size - 1 >= mapped_device.range.start) { return true; }
+    }
+    return false;
 }
 
-template<typename address_size>
+template<typename address_size, endian_t endian>
+Device<address_size>* Memory<address_size, endian>::findDevice(address_size address) const
+{
+    for(const MappedDevice &mapped_device : devices)
+    {
+        if(address >= mapped_device.range.start && address <= mapped_device.range.end) { return mapped_device.device; }
+    }
+    return NULL;
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::readBytes(address_size address, byte *data, address_size size)
+{
+    while(size > 0)
+    {
+        Device<address_size> *device = isIOPage(address >> PAGE_BITS) ? findDevice(address) : NULL;
+        address_size count = (device != NULL) ? device->read(address, data, size) : 0;
+        if(count == 0)  // the byte is plain memory
+        {
+            *data = readRAM(address);
+            count = 1;
+        }
+        address += count;
+        data += count;
+        size -= count;
+    }
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::writeBytes(address_size address, const byte *data, address_size size)
+{
+    while(size > 0)
+    {
+        Device<address_size> *device = isIOPage(address >> PAGE_BITS) ? findDevice(address) : NULL;
+        address_size count = (device != NULL) ? device->write(address, data, size) : 0;
+        if(count == 0)  // the byte is plain memory
+        {
+            writeRAM(address, *data);
+            count = 1;
+        }
+        address += count;
+        data += count;
+        size -= count;
+    }
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::setGuardBypass(bool bypass) { guest_space = bypass ? NULL : guarded_space; }
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::setRecoveryPoint(sigjmp_buf *recovery_point)
+{
+    static bool handler_installed = false;
+    if(guarded_space == NULL) { return; }
+
+    if(!handler_installed)
+    {
+        struct sigaction action = {};
+        action.sa_sigaction = handleGuardFault;
+        action.sa_flags = SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        handler_installed = sigaction(SIGSEGV, &action, NULL) == 0;
+    }
+
+    guard_recovery_point = recovery_point;
+    guarded_view_start = (recovery_point != NULL) ? guarded_space : NULL;
+    guarded_view_end = (recovery_point != NULL) ? guarded_space + ADDRESS_SPACE_SIZE + PAGE_SIZE : NULL;
+}
+
+template<typename address_size, endian_t endian>
+template<typename word_size>
+word_size Memory<address_size, endian>::load(address_size address)
+{
+    if(guest_space == NULL) { return getWord<word_size>(address); }
+
+    // restricted and I/O pages are guarded, so those loads fault here instead of being range checked or dispatched
+    word_size data;
+    memcpy(&data, guest_space + address, sizeof(word_size));
+    countAccess(address, false);  // only once the load can't fault anymore, since a faulting load is counted when it's rerun
+    return (endian == HOST_ENDIAN) ? data : byteSwap(data);
+}
+
+template<typename address_size, endian_t endian>
 template<typename word_size>
-word_size Memory<address_size>::getWord(address_size address)
+void Memory<address_size, endian>::store(address_size address, word_size data)
+{
+    if(guest_space == NULL)
+    {
+        setWord<word_size>(address, data);
+        return;
+    }
+
+    // restricted and I/O pages are guarded, so those stores fault here instead of being range checked or dispatched
+    if(endian != HOST_ENDIAN) { data = byteSwap(data); }
+    memcpy(guest_space + address, &data, sizeof(word_size));
+    countAccess(address, true);
+    markDirty(address);
+    markDirty(address + sizeof(word_size) - 1);
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::freePages()
+{
+    flushTLB();
+
+    forEachTable([this](address_size table_index, PageTable *&table)
+    {
+        if(table == NULL) { return; }
+        for(address_size i = 0; i < TABLE_SIZE; i++)
+        {
+            if((*table)[i] != NULL && !isShared((table_index << TABLE_BITS) | i, (*table)[i])) { delete [] (*table)[i]; }
+        }
+        delete [] table;
+        table = NULL;
+    });
+    if(radix_root != NULL) { freeRadixNode(radix_root, RADIX_LEVELS - 1); }
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::takeSnapshot()
+{
+    discardSnapshot();
+    if(sizeof(address_size) <= 4) { dirty_bitmap = new double_word[((double_word) 1 << (32 - PAGE_BITS)) / 64](); }
+    else { sparse_dirty_bitmap = new std::unordered_map<address_size, double_word>(); }
+    every_page_dirty = false;
+
+    switch(backend)
+    {
+        case HASHED:
+            snapshot_RAM = new std::unordered_map<address_size, byte>(*RAM);
+            break;
+
+        case PAGED:
+        {
+            // every page is shared with the snapshot, so the TLB must stop handing out pages for writing without copying them
+            flushTLB();
+            snapshot_pages = new std::unordered_map<address_size, byte*>();
+            forEachTable([this](address_size table_index, PageTable *table)
+            {
+                if(table == NULL) { return; }
+                for(address_size i = 0; i < TABLE_SIZE; i++)
+                {
+                    if((*table)[i] != NULL) { (*snapshot_pages)[(table_index << TABLE_BITS) | i] = (*table)[i]; }
+                }
+            });
+            break;
+        }
+
+        case MAPPED:
+        case GUARDED:
+        {
+            // the pages of a host mapping can't be shared, so the resident pages that hold any data are copied
+            snapshot_pages = new std::unordered_map<address_size, byte*>();
+            std::vector<unsigned char> resident(ADDRESS_SPACE_SIZE / PAGE_SIZE);
+            if(mincore(address_space, ADDRESS_SPACE_SIZE, resident.data()) == -1)
+            {
+                perror("Error finding resident guest memory");
+                break;
+            }
+            for(double_word page_number = 0; page_number < ADDRESS_SPACE_SIZE / PAGE_SIZE; page_number++)
+            {
+                byte *page = address_space + page_number * PAGE_SIZE;
+                if((resident[page_number] & 1) == 0 || (page[0] == 0 && memcmp(page, page + 1, PAGE_SIZE - 1) == 0)) { continue; }
+                byte *copy = new byte[PAGE_SIZE];
+                memcpy(copy, page, PAGE_SIZE);
+                (*snapshot_pages)[page_number] = copy;
+            }
+            break;
+        }
+    }
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::restoreSnapshot()
+{
+    clear();
+    switch(backend)
+    {
+        case HASHED:
+            if(snapshot_RAM != NULL) { *RAM = *snapshot_RAM; }
+            break;
+
+        case PAGED:
+            // pages written since the snapshot were copies and have just been freed, so the snapshot's pages are shared again
+            if(snapshot_pages != NULL)
+            {
+                for(auto &entry : *snapshot_pages) { getPageSlot(entry.first << PAGE_BITS) = entry.second; }
+            }
+            break;
+
+        case MAPPED:
+        case GUARDED:
+            if(snapshot_pages != NULL)
+            {
+                for(auto &entry : *snapshot_pages) { memcpy(address_space + entry.first * PAGE_SIZE, entry.second, PAGE_SIZE); }
+            }
+            break;
+    }
+    cleanPages();
+    every_page_dirty = false;
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::discardSnapshot()
+{
+    delete [] dirty_bitmap;
+    dirty_bitmap = NULL;
+    delete sparse_dirty_bitmap;
+    sparse_dirty_bitmap = NULL;
+    dirty_pages.clear();
+
+    delete snapshot_RAM;
+    snapshot_RAM = NULL;
+    if(snapshot_pages == NULL) { return; }
+
+    // pages still shared with memory are left to it
+    for(auto &entry : *snapshot_pages)
+    {
+        if(backend != PAGED || findPage(entry.first << PAGE_BITS) != entry.second) { delete [] entry.second; }
+    }
+    delete snapshot_pages;
+    snapshot_pages = NULL;
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::resetToBaseline()
+{
+    if(every_page_dirty || (dirty_bitmap == NULL && sparse_dirty_bitmap == NULL))
+    {
+        restoreSnapshot();
+        return;
+    }
+
+    for(address_size page_number : dirty_pages)
+    {
+        address_size page_address = page_number << PAGE_BITS;
+        reportWrite(page_number);  // the page may have been watched again since it was first written
+        switch(backend)
+        {
+            case HASHED:
+                for(address_size i = 0; i < PAGE_SIZE; i++)
+                {
+                    auto entry = snapshot_RAM->find(page_address + i);
+                    if(entry != snapshot_RAM->end()) { (*RAM)[page_address + i] = entry->second; }
+                    else { RAM->erase(page_address + i); }
+                }
+                break;
+
+            case PAGED:
+            {
+                // a written page is never shared, so it's freed and replaced by the snapshot's page (if there is one)
+                byte *&page = getPageSlot(page_address);
+                auto entry = snapshot_pages->find(page_number);
+                if(!isShared(page_number, page)) { delete [] page; }
+                page = (entry != snapshot_pages->end()) ? entry->second : NULL;
+                break;
+            }
+
+            case MAPPED:
+            case GUARDED:
+            {
+                auto entry = snapshot_pages->find(page_number);
+                if(entry != snapshot_pages->end()) { memcpy(address_space + page_address, entry->second, PAGE_SIZE); }
+                else { madvise(address_space + page_address, PAGE_SIZE, (guarded_space == NULL) ? MADV_DONTNEED : MADV_REMOVE); }
+                break;
+            }
+        }
+    }
+    if(backend == PAGED) { flushTLB(); }
+    cleanPages();
+}
+
+template<typename address_size, endian_t endian>
+address_size Memory<address_size, endian>::getDirtyPageCount() { return dirty_pages.size(); }
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::markDirty(address_size address)
+{
+    if(write_watcher != NULL) { reportWrite(address >> PAGE_BITS); }
+    if(dirty_bitmap == NULL && sparse_dirty_bitmap == NULL) { return; }
+
+    address_size page_number = address >> PAGE_BITS;
+    double_word bit = (double_word) 1 << (page_number & 63);
+    double_word &bits = (dirty_bitmap != NULL) ? dirty_bitmap[page_number >> 6] : (*sparse_dirty_bitmap)[page_number >> 6];
+    if((bits & bit) == 0)
+    {
+        bits |= bit;
+        dirty_pages.push_back(page_number);
+    }
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::cleanPages()
+{
+    if(dirty_bitmap != NULL)
+    {
+        for(address_size page_number : dirty_pages) { dirty_bitmap[page_number >> 6] = 0; }
+    }
+    if(sparse_dirty_bitmap != NULL) { sparse_dirty_bitmap->clear(); }
+    dirty_pages.clear();
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::setWriteWatcher(WriteWatcher<address_size> *watcher)
+{
+    delete [] watch_bitmap;
+    watch_bitmap = NULL;
+    delete sparse_watch_bitmap;
+    sparse_watch_bitmap = NULL;
+    write_watcher = watcher;
+    if(watcher == NULL) { return; }
+
+    if(sizeof(address_size) <= 4) { watch_bitmap = new double_word[((double_word) 1 << (32 - PAGE_BITS)) / 64](); }
+    else { sparse_watch_bitmap = new std::unordered_map<address_size, double_word>(); }
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::watchPage(address_size page_number)
+{
+    if(write_watcher == NULL) { return; }
+    double_word &bits = (watch_bitmap != NULL) ? watch_bitmap[page_number >> 6] : (*sparse_watch_bitmap)[page_number >> 6];
+    bits |= (double_word) 1 << (page_number & 63);
+
+    // writes to a cached page skip markDirty, so the page has to miss again
+    TLBEntry &entry = write_tlb[page_number & (TLB_SIZE - 1)];
+    if(entry.page_number == page_number) { entry.page = NULL; }
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::reportWrite(address_size page_number)
+{
+    if(write_watcher == NULL) { return; }
+    double_word bit = (double_word) 1 << (page_number & 63);
+    double_word *bits;
+    if(watch_bitmap != NULL) { bits = &watch_bitmap[page_number >> 6]; }
+    else
+    {
+        auto entry = sparse_watch_bitmap->find(page_number >> 6);
+        if(entry == sparse_watch_bitmap->end()) { return; }
+        bits = &entry->second;
+    }
+    if((*bits & bit) == 0) { return; }
+
+    *bits &= ~bit;
+    write_watcher->pageWritten(page_number);
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::reportAllWrites()
+{
+    if(write_watcher == NULL) { return; }
+
+    std::vector<address_size> page_numbers;
+    if(watch_bitmap != NULL)
+    {
+        for(double_word i = 0; i < ((double_word) 1 << (32 - PAGE_BITS)) / 64; i++)
+        {
+            for(double_word bits = watch_bitmap[i]; bits != 0; bits &= bits - 1) { page_numbers.push_back(i * 64 + __builtin_ctzll(bits)); }
+            watch_bitmap[i] = 0;
+        }
+    }
+    else
+    {
+        for(auto &entry : *sparse_watch_bitmap)
+        {
+            for(double_word bits = entry.second; bits != 0; bits &= bits - 1) { page_numbers.push_back(entry.first * 64 + __builtin_ctzll(bits)); }
+        }
+        sparse_watch_bitmap->clear();
+    }
+    for(address_size page_number : page_numbers) { write_watcher->pageWritten(page_number); }
+}
+
+template<typename address_size, endian_t endian>
+byte Memory<address_size, endian>::getByte(address_size address)
+{
+    countAccess(address, false);
+    if(isIOPage(address >> PAGE_BITS))
+    {
+        byte data;
+        readBytes(address, &data, 1);
+        return data;
+    }
+    return readRAM(address);
+}
+
+template<typename address_size, endian_t endian>
+byte Memory<address_size, endian>::readRAM(address_size address)
+{
+    switch(backend)
+    {
+        case HASHED:
+            if(RAM->count(address) == 0) { (*RAM)[address] = 0; }
+            return RAM->at(address);
+
+        case MAPPED:
+        case GUARDED:
+            return address_space[address];
+
+        case PAGED:
+        default:
+        {
+            byte *page = translate(address, false);
+            return ((page != NULL) ? page : getPage(address, false))[address & PAGE_MASK];  // I/O pages aren't cached
+        }
+    }
+}
+
+template<typename address_size, endian_t endian>
+template<typename word_size>
+word_size Memory<address_size, endian>::getWord(address_size address)
 {
     word_size data = 0;
+    countAccess(address, false);
+
+    // words that are contiguous on the host (i.e. don't cross a page boundary) are read with a single host load
+    byte *host_address = getContiguous(address, sizeof(word_size), false);
+    if(host_address != NULL)
+    {
+        memcpy(&data, host_address, sizeof(word_size));
+        return (endian == HOST_ENDIAN) ? data : byteSwap(data);
+    }
+
+    // devices in the word's way are handed the bytes in their range together
+    byte bytes[sizeof(word_size)];
+    readBytes(address, bytes, sizeof(word_size));
+
     switch(endian)
     {
         case LITTLE:
             for(byte i = 0; i < sizeof(word_size); i++)
             {
-                data += (((word_size) getByte(address++)) << (i * 8));
+                data += (((word_size) bytes[i]) << (i * 8));
             }
             break;
         
         case BIG:
             for(byte i = 0; i < sizeof(word_size); i++)
             {
-                data += getByte(address++);
+                data += bytes[i];
                 if(i < (byte) sizeof(word_size) - 1) { data = data << 8; }
             }
             break;
@@ -49,44 +1021,217 @@ word_size Memory<address_size>::getWord(address_size address)
     return data;
 }
 
-template<typename address_size>
-void Memory<address_size>::setByte(address_size address, byte data)
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::setByte(address_size address, byte data)
 {
-    if (address != 0) { (*RAM)[address] = data; }
-    else { (*RAM)[1] |= 1; }  // attempting to store to address 0 will set the SAZ flag in the interrupt flags
+    countAccess(address, true);
+    if(isIOPage(address >> PAGE_BITS)) { writeBytes(address, &data, 1); }
+    else { writeRAM(address, data); }
 }
 
-template<typename address_size>
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::writeRAM(address_size address, byte data)
+{
+    switch(backend)
+    {
+        case HASHED:
+            (*RAM)[address] = data;
+            markDirty(address);
+            break;
+
+        case PAGED:
+        {
+            byte *page = translate(address, true);
+            ((page != NULL) ? page : getPage(address, true))[address & PAGE_MASK] = data;  // I/O pages aren't cached
+            break;
+        }
+
+        case MAPPED:
+        case GUARDED:
+            address_space[address] = data;
+            markDirty(address);
+            break;
+    }
+}
+
+template<typename address_size, endian_t endian>
 template <typename word_size>
-void Memory<address_size>::setWord(address_size address, word_size data)
+void Memory<address_size, endian>::setWord(address_size address, word_size data)
 {
-     // attempting to store to address 0 will set the SAZ flag in the interrupt flags
-    if (address == 0)
+    countAccess(address, true);
+    // words that are contiguous on the host (i.e. don't cross a page boundary) are written with a single host store
+    byte *host_address = getContiguous(address, sizeof(word_size), true);
+    if(host_address != NULL)
     {
-        (*RAM)[1] |= 1;
+        if(endian != HOST_ENDIAN) { data = byteSwap(data); }
+        memcpy(host_address, &data, sizeof(word_size));
         return;
     }
 
+    byte bytes[sizeof(word_size)];
     switch(endian)
     {
         case LITTLE:
             for(byte i = 0; i < sizeof(word_size); i++)
             {
-                setByte(address++, (byte) data);  // data is truncated to least significant byte
+                bytes[i] = (byte) data;  // data is truncated to least significant byte
                 data = data >> 8;
             }
             break;
 
         case BIG:
-            for(s_byte i = sizeof(word_size) - 1; i >= 0; i--) { setByte(address++, (byte) (data >> (8 * i))); }
+            for(s_byte i = sizeof(word_size) - 1; i >= 0; i--) { bytes[sizeof(word_size) - 1 - i] = (byte) (data >> (8 * i)); }
             break;
     }
+
+    // devices in the word's way are handed the bytes in their range together
+    writeBytes(address, bytes, sizeof(word_size));
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::readBlock(address_size address, byte *destination, address_size length)
+{
+    while(length > 0)
+    {
+        // copy at most up to the end of the current page at a time
+        address_size count = (length < PAGE_SIZE - (address & PAGE_MASK)) ? length : PAGE_SIZE - (address & PAGE_MASK);
+        countAccess(address, false);
+        byte *host_address = getContiguous(address, count, false);
+        if(host_address != NULL) { memcpy(destination, host_address, count); }
+        else
+        {
+            for(address_size i = 0; i < count; i++) { readBytes(address + i, destination + i, 1); }
+        }
+        address += count;
+        destination += count;
+        length -= count;
+    }
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::writeBlock(address_size address, const byte *source, address_size length)
+{
+    while(length > 0)
+    {
+        // copy at most up to the end of the current page at a time (bytes of I/O pages are stored one by one)
+        address_size count = (length < PAGE_SIZE - (address & PAGE_MASK)) ? length : PAGE_SIZE - (address & PAGE_MASK);
+        countAccess(address, true);
+        byte *host_address = getContiguous(address, count, true);
+        if(host_address != NULL) { memcpy(host_address, source, count); }
+        else
+        {
+            for(address_size i = 0; i < count; i++) { writeBytes(address + i, source + i, 1); }
+        }
+        address += count;
+        source += count;
+        length -= count;
+    }
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::fill(address_size address, byte value, address_size length)
+{
+    while(length > 0)
+    {
+        // fill at most up to the end of the current page at a time (bytes of I/O pages are stored one by one)
+        address_size count = (length < PAGE_SIZE - (address & PAGE_MASK)) ? length : PAGE_SIZE - (address & PAGE_MASK);
+        countAccess(address, true);
+        byte *host_address = getContiguous(address, count, true);
+        if(host_address != NULL) { memset(host_address, value, count); }
+        else
+        {
+            for(address_size i = 0; i < count; i++) { writeBytes(address + i, &value, 1); }
+        }
+        address += count;
+        length -= count;
+    }
+}
+
+template<typename address_size, endian_t endian>
+byte Memory<address_size, endian>::peekByte(address_size address) const
+{
+    byte data;
+    peekRange(address, &data, 1);
+    return data;
+}
+
+template<typename address_size, endian_t endian>
+template<typename word_size>
+word_size Memory<address_size, endian>::peekWord(address_size address) const
+{
+    byte bytes[sizeof(word_size)];
+    peekRange(address, bytes, sizeof(word_size));
+
+    word_size data = 0;
+    for(byte i = 0; i < sizeof(word_size); i++)
+    {
+        if(endian == LITTLE) { data |= ((word_size) bytes[i]) << (i * 8); }
+        else { data = (data << 8) | bytes[i]; }
+    }
+    return data;
+}
+
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::peekRange(address_size address, byte *destination, address_size length) const
+{
+    while(length > 0)
+    {
+        // copy at most up to the end of the current page at a time
+        address_size offset = address & PAGE_MASK;
+        address_size count = (length < PAGE_SIZE - offset) ? length : PAGE_SIZE - offset;
+        switch(backend)
+        {
+            case HASHED:
+                for(address_size i = 0; i < count; i++)
+                {
+                    auto entry = RAM->find(address + i);
+                    destination[i] = (entry != RAM->end()) ? entry->second : 0;
+                }
+                break;
+
+            case PAGED:
+            {
+                const byte *page = findPage(address);
+                if(page != NULL) { memcpy(destination, page + offset, count); }
+                else { memset(destination, 0, count); }
+                break;
+            }
+
+            case MAPPED:
+            case GUARDED:
+                // reading an untouched private page would map the kernel's shared zero page, which then counts as
+                // resident, and reading a hole in a shared memory file through a mapping would allocate it
+                if(memory_file == -1)
+                {
+                    unsigned char resident = 0;
+                    if(mincore(address_space + (address - offset), PAGE_SIZE, &resident) == 0 && (resident & 1) != 0)
+                    {
+                        memcpy(destination, address_space + address, count);
+                    }
+                    else { memset(destination, 0, count); }
+                }
+                else if(pread(memory_file, destination, count, address) != (ssize_t) count) { memset(destination, 0, count); }
+                break;
+        }
+        if(isIOPage(address >> PAGE_BITS))  // devices overwrite the bytes in their range
+        {
+            for(address_size i = 0; i < count;)
+            {
+                Device<address_size> *device = findDevice(address + i);
+                address_size peeked = (device != NULL) ? device->peek(address + i, destination + i, count - i) : 0;
+                i += (peeked != 0) ? peeked : 1;
+            }
+        }
+        address += count;
+        destination += count;
+        length -= count;
+    }
 }
 
-template<typename address_size>
-void Memory<address_size>::printByte(address_size address, bool endline, base_t base)
+template<typename address_size, endian_t endian>
+void Memory<address_size, endian>::printByte(address_size address, bool endline, base_t base) const
 {
-    byte data = getByte(address);
+    byte data = peekByte(address);
     switch(base)
     {
         case BIN:
@@ -109,9 +1254,9 @@ void Memory<address_size>::printByte(address_size address, bool endline, base_t
     if(endline) { printf("\n"); }
 }
 
-template<typename address_size>
+template<typename address_size, endian_t endian>
 template <typename word_size>
-void Memory<address_size>::printWord(address_size address, bool endline, base_t base)
+void Memory<address_size, endian>::printWord(address_size address, bool endline, base_t base) const
 {
     switch(endian)
     {
@@ -2,7 +2,12 @@
 #define MEMORY_H
 
 #include <unordered_map>
+#include <vector>
+#include <setjmp.h>
+#include <stdio.h>
 #include "../Utilities/DataTypes.h"
+#include "../Utilities/ByteSwap.h"
+#include "Device.h"
 
 typedef enum
 {
@@ -10,12 +15,45 @@ typedef enum
     BIG
 } endian_t;
 
+// byte order of the machine running the emulator
+constexpr endian_t HOST_ENDIAN = (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__) ? BIG : LITTLE;
+
+typedef enum
+{
+    HASHED,  // every byte is a separate hash map entry
+    PAGED,   // 4 KiB pages held in a radix tree of page tables and allocated on first touch
+    MAPPED,  // the whole 32-bit address space is one lazily committed host mapping (falls back to PAGED for wider addresses)
+    GUARDED  // MAPPED, plus a second view for guest loads and stores where restricted pages fault (falls back to MAPPED)
+} memory_backend_t;
+
+struct TLBStatistics  // hit and miss counts of the page pointer cache in front of a PAGED memory
+{
+    double_word read_hits = 0;
+    double_word read_misses = 0;
+    double_word write_hits = 0;
+    double_word write_misses = 0;
+};
+
+struct PageCounters  // loads and stores that touched one page (a whole word or block counts as one access)
+{
+    double_word reads = 0;
+    double_word writes = 0;
+};
+
 template <typename address_size = word>
+class WriteWatcher  // told when memory is about to write a page it was asked to watch
+{
+    public:
+        virtual ~WriteWatcher() {}
+        virtual void pageWritten(address_size page_number) = 0;
+};
+
+// byte order is a template parameter, so words in the host's byte order are accessed with plain host loads and stores
+template <typename address_size = word, endian_t endian = LITTLE>
 class Memory
 {
     public:
-        Memory();
-        Memory(endian_t endian);
+        Memory(memory_backend_t backend = PAGED);
         ~Memory();
         void clear();  // clears all data stored in memory
         byte getByte(address_size address);
@@ -24,13 +62,151 @@ class Memory
         void setByte(address_size address, byte data);
         template <typename word_size = address_size>
             void setWord(address_size address, word_size data);  // word as in word_size, not necessarily 32 bits
-        void printByte(address_size address, bool endline = true, base_t base = HEX);
+        void printByte(address_size address, bool endline = true, base_t base = HEX) const;
+        template <typename word_size = address_size>
+            void printWord(address_size address, bool endline = true, base_t base = HEX) const;  // word as in word_size, not necessarily 32 bits
+        TLBStatistics getTLBStatistics();
+        static constexpr endian_t getEndian();
+        memory_backend_t getBackend();
+        bool setHugePages(AddressRange<address_size> range, bool huge);  // asks the host to back range with 2 MiB pages (false if it can't)
+
+        // Footprint and access statistics
+        double_word getResidentPages();  // pages currently backed by host memory
+        double_word getResidentPages(AddressRange<address_size> range);
+        void setPageCounting(bool counting);  // counts reads and writes per page (off by default, and resets the counts)
+        void dumpStatistics(FILE *file);
+
+        // Bulk copies of bytes in address order (bytes on I/O pages are accessed one at a time, like getByte and setByte)
+        void readBlock(address_size address, byte *destination, address_size length);
+        void writeBlock(address_size address, const byte *source, address_size length);
+        void fill(address_size address, byte value, address_size length);
+
+        // A saved copy of the memory's contents (PAGED memory shares its pages with the snapshot until they're written)
+        void takeSnapshot();  // replaces any earlier snapshot and becomes the baseline written pages are tracked from
+        void restoreSnapshot();  // clears memory if no snapshot was taken
+        void discardSnapshot();
+        void resetToBaseline();  // restores only the pages written since the snapshot was taken
+        address_size getDirtyPageCount();
+
+        // Reads that never allocate memory (untouched addresses read as zero)
+        byte peekByte(address_size address) const;
+        template <typename word_size = address_size>
+            word_size peekWord(address_size address) const;  // word as in word_size, not necessarily 32 bits
+        void peekRange(address_size address, byte *destination, address_size length) const;  // copies bytes in address order
+
+        // Guest loads and stores (GUARDED memory performs them without any range checks)
+        template <typename word_size = address_size>
+            word_size load(address_size address);
         template <typename word_size = address_size>
-            void printWord(address_size address, bool endline = true, base_t base = HEX);  // word as in word_size, not necessarily 32 bits
+            void store(address_size address, word_size data);
+        bool isGuarded();
+        void guardRange(AddressRange<address_size> range, bool guarded);  // guarded loads and stores fault instead of accessing range
+        void setGuardBypass(bool bypass);  // loads and stores ignore guards while bypassed
+        void setRecoveryPoint(sigjmp_buf *recovery_point);  // faulting loads and stores jump to recovery_point (NULL to stop)
+
+        // Memory-mapped I/O (pages that any device's range touches are I/O pages, which never take a fast path)
+        void attachDevice(AddressRange<address_size> range, Device<address_size> *device);  // accesses to range go to device
+        void detachDevice(Device<address_size> *device);
+        bool overlapsDevice(address_size address, address_size size) const;  // the bytes mustn't wrap around
+
+        // Write watching (the watcher is told once about the next write to each watched page, including restores and clears)
+        void setWriteWatcher(WriteWatcher<address_size> *watcher);  // replaces any earlier watcher and its pages (NULL to stop)
+        void watchPage(address_size page_number);
+
+        static constexpr byte PAGE_BITS = 12;                     // pages are 4 KiB
+        static constexpr address_size PAGE_SIZE = 1 << PAGE_BITS;
+        static constexpr address_size PAGE_MASK = PAGE_SIZE - 1;
 
     private:
-        std::unordered_map<address_size, byte> *RAM;
-        endian_t endian;
+        static constexpr byte TABLE_BITS = 10;                    // each page table holds 1024 pages (4 MiB)
+        static constexpr address_size TABLE_SIZE = 1 << TABLE_BITS;
+        static constexpr byte DIRECTORY_BITS = 32 - PAGE_BITS - TABLE_BITS;  // directory covers a 32-bit address space
+        static constexpr byte RADIX_BITS = 11;                    // each node of a wider address space's radix tree holds 2048 entries
+        static constexpr address_size RADIX_SIZE = 1 << RADIX_BITS;
+        static constexpr byte RADIX_LEVELS = (sizeof(address_size) * 8 - PAGE_BITS - TABLE_BITS + RADIX_BITS - 1) / RADIX_BITS;
+        static constexpr address_size TABLE_CACHE_SIZE = 8;      // page tables whose radix tree walks are cached
+
+        static constexpr address_size TLB_SIZE = 64;             // entries in each of the read and write caches
+        static constexpr double_word ADDRESS_SPACE_SIZE = (double_word) 1 << 32;  // bytes reserved by the MAPPED backend
+        static constexpr double_word HUGE_PAGE_SIZE = 1 << 21;    // host transparent huge pages are 2 MiB
+
+        typedef byte* PageTable[TABLE_SIZE];
+        typedef void* RadixNode[RADIX_SIZE];  // child nodes, or page tables in the nodes of the lowest level
+
+        struct MappedDevice
+        {
+            AddressRange<address_size> range;
+            Device<address_size> *device;
+        };
+
+        struct TLBEntry
+        {
+            address_size page_number;
+            byte *page;  // NULL if the entry is empty
+        };
+
+        struct TableCacheEntry
+        {
+            address_size table_index;
+            PageTable **slot;  // where the radix tree holds the page table (NULL if the entry is empty)
+        };
+
+        PageTable*& getTableSlot(address_size table_index);  // returns the directory entry for a page table, allocating radix nodes
+        PageTable* findTable(address_size table_index) const;  // returns NULL if no page in the table was ever touched
+        template <typename Visit>
+            void forEachTable(Visit visit);  // calls visit(table_index, table) for every allocated page table
+        template <typename Visit>
+            void visitRadixNode(RadixNode *node, byte level, address_size table_index, Visit &visit);
+        void freeRadixNode(RadixNode *node, byte level);  // frees the node's children (its page tables must be freed already)
+        byte*& getPageSlot(address_size address);  // returns the page table entry for address, allocating its table
+        byte* getPage(address_size address, bool write);  // returns the page holding address, allocating it on first touch
+        const byte* findPage(address_size address) const;  // returns NULL if the page holding address was never touched
+        byte* translate(address_size address, bool write);  // returns the page holding address through the TLB
+        byte* getContiguous(address_size address, address_size size, bool write);  // returns NULL if the bytes aren't contiguous on the host
+        void flushTLB();  // must be called whenever a page is freed or remapped
+        byte readRAM(address_size address);  // getByte, bypassing devices
+        void writeRAM(address_size address, byte data);  // setByte, bypassing devices
+        void readBytes(address_size address, byte *data, address_size size);  // hands devices the bytes in their range
+        void writeBytes(address_size address, const byte *data, address_size size);  // hands devices the bytes in their range
+        bool isIOPage(address_size page_number) const;
+        Device<address_size>* findDevice(address_size address) const;  // returns NULL if no device is mapped at address
+        void markIOPages(AddressRange<address_size> range);
+        void guardIOPages();  // makes guest loads and stores fault on every I/O page
+        void countAccess(address_size address, bool write);
+        void freePages();  // frees every page that isn't shared with the snapshot
+        bool isShared(address_size page_number, const byte *page) const;  // returns true if page also belongs to the snapshot
+        void markDirty(address_size address);  // records a write to the page holding address while there's a baseline
+        void cleanPages();  // forgets every write recorded since the baseline
+        void reportWrite(address_size page_number);  // tells the watcher if the page is watched, and stops watching it
+        void reportAllWrites();  // reports every watched page
+        void mapGuardedAddressSpace();
+        static byte* reserveAddressSpace(double_word size);  // inaccessible and aligned to a huge page (NULL if it fails)
+
+        std::unordered_map<address_size, byte> *RAM;  // HASHED backend
+        PageTable **directory;  // PAGED backend for 32-bit addresses
+        RadixNode *radix_root;  // PAGED backend for addresses wider than 32 bits (lower nodes are allocated on first touch)
+        TableCacheEntry table_cache[TABLE_CACHE_SIZE];  // skips the radix tree walk for recently used page tables
+        byte *address_space;  // MAPPED backend
+        byte *guarded_space;  // GUARDED backend's view of address_space used by guest loads and stores
+        byte *guest_space;  // guarded_space unless guards are bypassed (NULL makes loads and stores use getWord/setWord)
+        int memory_file;  // file shared by both GUARDED views (-1 for other backends)
+        std::vector<MappedDevice> devices;
+        double_word *io_bitmap;  // one bit per I/O page for 32-bit addresses (NULL until a device is attached)
+        std::unordered_map<address_size, double_word> *sparse_io_bitmap;  // same for wider addresses, by page number / 64
+        std::unordered_map<address_size, byte> *snapshot_RAM;  // HASHED snapshot (NULL if none was taken)
+        std::unordered_map<address_size, byte*> *snapshot_pages;  // snapshot's pages by page number (NULL if none was taken)
+        double_word *dirty_bitmap;  // one bit per page written since the baseline for 32-bit addresses (NULL if no baseline)
+        std::unordered_map<address_size, double_word> *sparse_dirty_bitmap;  // same for wider addresses, by page number / 64
+        std::vector<address_size> dirty_pages;  // page numbers of the set bits, so resets don't scan the bitmap
+        bool every_page_dirty;  // memory was cleared since the baseline, so every page has to be restored
+        WriteWatcher<address_size> *write_watcher;  // NULL if writes aren't watched
+        double_word *watch_bitmap;  // one bit per watched page for 32-bit addresses (NULL if writes aren't watched)
+        std::unordered_map<address_size, double_word> *sparse_watch_bitmap;  // same for wider addresses, by page number / 64
+        TLBEntry read_tlb[TLB_SIZE];
+        TLBEntry write_tlb[TLB_SIZE];
+        TLBStatistics tlb_statistics;
+        std::unordered_map<address_size, PageCounters> *page_counters;  // by page number (NULL unless pages are counted)
+        memory_backend_t backend;
 };
 
 #endif
\ No newline at end of file
@@ -1,168 +1,208 @@
 #include "RISC_V.h"
 #include "stdio.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include "../Utilities/HexDump.h"
 
-template <typename word_size>
-RISC_V<word_size>::RISC_V(byte number_of_registers, endian_t endian) 
+template <typename word_size, endian_t endian>
+RISC_V<word_size, endian>::RISC_V(byte number_of_registers, memory_backend_t memory_backend) 
 { 
-    pc = new Counter<word_size>(4);
-    ir = new Register<word>;
-    alu = new ALU<word_size>;
-    register_set = new Register<word_size>[number_of_registers]{Register<word_size>(0, true)};  // x0 is always hardcoded to zero
-    constants = new ConstantList<word_size>{{0x80, Register<word_size>(0x80, true)}, {0x800, Register<word_size>(0x800, true)},
-                                            {0x1000, Register<word_size>(0x1000, true)}, {0x8000, Register<word_size>(0x8000, true)},
-                                            {0x100000, Register<word_size>(0x100000, true)}, {0x80000000, Register<word_size>(0x80000000, true)}};
-    memory = new Memory<word_size>(endian);
+    hart = HartState<word_size>();  // x0 is never written, so it stays zero
+    memory = new Memory<word_size, endian>(memory_backend);
     extensions = NULL;
+    decode_cache = new DecodeCache<word_size, endian>(memory);
+    decoding_extension = NULL;
+    extension_owners.assign(1 << 15, 0);
+    setBaseHandlers();
+    jit = NULL;
+    native_block = NULL;
+    tiers = DEFAULT_TIERS;
     base = "";
     num_registers = number_of_registers;
     running = false;
     restarting = false;
+    check_memory_accesses = !memory->isGuarded();
+    guards_active = false;
+    for (int tier = INTERPRETER; tier < NUM_TIERS; tier++)
+    {
+        tier_instructions[tier] = 0;
+        tier_seconds[tier] = 0;
+    }
+    current_tier = INTERPRETER;
+    system_device = new SystemDevice<word_size>(&hart.interrupt_flags);
+    memory->attachDevice(SystemDevice<word_size>::ADDRESS_RANGE, system_device);
     bootloader_address_range = {0x4, 0x7FF};  // by default, bootloader program should start at address 0x4 and end at address 0x7FF
     program_address_range = {0x800, 0x400007FF};  // by default, main program should start at address 0x800 and end at address 0x400007FF
     global_data_address_range = {0x40000800, 0x800007FF};  // by default, global data should start at address 0x40000800 and end at address 0x800007FF
     interrupt_handler_address_range = {0xFFFFF800, 0xFFFFFFFF};  // by default, interrupt handler should start at address 0xFFFFF800 and end at address 0xFFFFFFFF
+    stack_address_range = {0x80000800, 0xFFFFF7FF};  // by default, the stack lies between the global data and the interrupt handler (the bootloader starts it at 0xE0000800)
+    statistics_filename = "";
+    program_filename = "./Programs/program";
 }
 
-template <typename word_size>
-RISC_V<word_size>::RISC_V(byte number_of_registers, endian_t endian, ExtensionList<word_size> &extension_list)
-    : RISC_V(number_of_registers, endian)
+template <typename word_size, endian_t endian>
+RISC_V<word_size, endian>::RISC_V(byte number_of_registers, ExtensionList<word_size, endian> &extension_list,
+                                  memory_backend_t memory_backend)
+    : RISC_V(number_of_registers, memory_backend)
 {
-    extensions = new ExtensionList<word_size>();
+    extensions = new ExtensionList<word_size, endian>();
     RISC_V_Components components = getComponents();
-    for(Extension<word_size> *extension_ptr : extension_list)
+    for(Extension<word_size, endian> *extension_ptr : extension_list)
     {
         extensions->push_back(extension_ptr->create(components));
+        claimEncodings(extensions->size(), extensions->back()->getEncodings());
     }
 }
 
-template <typename word_size>
-RISC_V<word_size>::RISC_V(ExtensionList<word_size> &extension_list) : RISC_V(32, LITTLE, extension_list) {}
+template <typename word_size, endian_t endian>
+RISC_V<word_size, endian>::RISC_V(ExtensionList<word_size, endian> &extension_list) : RISC_V(32, extension_list) {}
 
-template <typename word_size>
-RISC_V<word_size>::~RISC_V() 
+template <typename word_size, endian_t endian>
+RISC_V<word_size, endian>::~RISC_V() 
 {
-    delete pc;
-    delete ir;
-    delete alu;
-    delete [] register_set;
-    delete constants;
+    delete jit;
+    delete decode_cache;  // stops watching memory, so it must go first
     delete memory;
+    delete system_device;
     if(extensions != NULL) 
     {
-        for(Extension<word_size> *extension : *extensions) { delete extension; }
+        for(Extension<word_size, endian> *extension : *extensions) { delete extension; }
         delete extensions;
     }
 }
 
-template <typename word_size>
-bool RISC_V<word_size>::loadMemory() 
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::loadMemory() 
 {
     // assemble programs
     // open binary files containing machine code
-    FILE *bootloader_ptr, *program_ptr, *global_data_ptr, *interrupt_handler_ptr;
-    bootloader_ptr = fopen("./Programs/bootloader", "rb");
-    if (bootloader_ptr == NULL) 
+    int bootloader_file, program_file, global_data_file, interrupt_handler_file;
+    bootloader_file = open("./Programs/bootloader", O_RDONLY);
+    if (bootloader_file == -1) 
     {
         perror("Error opening bootloader");
         return false;
     }
 
-    program_ptr = fopen("./Programs/program", "rb");
-    if (program_ptr == NULL)
+    program_file = open(program_filename.c_str(), O_RDONLY);
+    if (program_file == -1)
     {
         perror("Error opening main program");
         return false;
     }
 
-    global_data_ptr = fopen("./Programs/program_data", "rb");
-    if (global_data_ptr == NULL)
+    global_data_file = open((program_filename + "_data").c_str(), O_RDONLY);
+    if (global_data_file == -1)
     {
         perror("Error opening global data");
         return false;
     }
 
-    interrupt_handler_ptr = fopen("./Programs/interrupt_handler", "rb");
-    if (interrupt_handler_ptr == NULL)
+    interrupt_handler_file = open("./Programs/interrupt_handler", O_RDONLY);
+    if (interrupt_handler_file == -1)
     {
         perror("Error opening interrupt handler");
         return false;
     }
 
     // load machine code into respective memory addresses
-    // Bootloader
-    word_size curr_address = bootloader_address_range.start;
-    word curr_instruction = 0;
-    while((curr_address+3 <= bootloader_address_range.end)  // last byte of instruction must fit in range
-       && (fread(&curr_instruction, sizeof(word), 1, bootloader_ptr) != 0))  // AND there must still be data left in the file to read
-    {
-        memory-> template setWord<word>(curr_address, curr_instruction);
-        curr_address += 4;
-    }
-
-    if((curr_address+3 > bootloader_address_range.end)
-       && (fread(&curr_instruction, sizeof(word), 1, bootloader_ptr) != 0))  // if bootloader code doesn't fit inside memory space
+    bool loaded = true;
+    if (loaded && !loadSegment(bootloader_file, bootloader_address_range, true))
     {
         printf("Error: Bootloader cannot fit in allocated memory space\n");
-        return false;
+        loaded = false;
     }
 
-    // Main Program
-    curr_address = program_address_range.start;
-    curr_instruction = 0;
-    while((curr_address+3 <= program_address_range.end)  // last byte of instruction must fit in range
-       && (fread(&curr_instruction, sizeof(word), 1, program_ptr) != 0))  // AND there must still be data left in the file to read
+    if (loaded && !loadSegment(program_file, program_address_range, true))
     {
-        memory-> template setWord<word>(curr_address, curr_instruction);
-        curr_address += 4;
+        printf("Error: Main program cannot fit in allocated memory space\n");
+        loaded = false;
     }
 
-    if((curr_address+3 > program_address_range.end)
-       && (fread(&curr_instruction, sizeof(word), 1, program_ptr) != 0))  // if main program code doesn't fit inside memory space
+    if (loaded && !loadSegment(global_data_file, global_data_address_range, false))
     {
-        printf("Error: Main program cannot fit in allocated memory space\n");
-        return false;
+        printf("Error: Global data cannot fit in allocated memory space\n");
+        loaded = false;
     }
 
-    // Global Data
-    curr_address = global_data_address_range.start;
-    byte curr_data = 0;
-    while((curr_address <= global_data_address_range.end)  // last byte of instruction must fit in range
-       && (fread(&curr_data, sizeof(byte), 1, global_data_ptr) != 0))  // AND there must still be data left in the file to read
+    if (loaded && !loadSegment(interrupt_handler_file, interrupt_handler_address_range, true))
     {
-        memory->setByte(curr_address, curr_data);
-        curr_address++;
+        printf("Error: Interrupt handler cannot fit in allocated memory space\n");
+        loaded = false;
     }
 
-    if((curr_address > global_data_address_range.end)
-       && (fread(&curr_data, sizeof(byte), 1, global_data_ptr) != 0))  // if main program code doesn't fit inside memory space
+    close(bootloader_file);
+    close(program_file);
+    close(global_data_file);
+    close(interrupt_handler_file);
+    return loaded;
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::loadSegment(int file, AddressRange<word_size> range, bool instructions)
+{
+    // instructions are stored as whole words in host byte order, while data is stored byte by byte
+    const word_size unit_size = instructions ? sizeof(word) : sizeof(byte);
+    const word_size capacity = (range.end - range.start + 1) / unit_size * unit_size;  // bytes of whole units that fit in range
+    const bool swap = instructions && endian != HOST_ENDIAN;
+
+    auto toMemoryOrder = [](byte *instructions, size_t length)
     {
-        printf("Error: Global data cannot fit in allocated memory space\n");
-        return false;
-    }
+        for (size_t i = 0; i < length; i += sizeof(word))
+        {
+            word instruction;
+            memcpy(&instruction, instructions + i, sizeof(word));
+            instruction = byteSwap(instruction);
+            memcpy(instructions + i, &instruction, sizeof(word));
+        }
+    };
 
-    // Interrupt Handler
-    curr_address = interrupt_handler_address_range.start;
-    curr_instruction = 0;
-    while((curr_address+3 <= interrupt_handler_address_range.end)  // last byte of instruction must fit in range
-       && (fread(&curr_instruction, sizeof(word), 1, interrupt_handler_ptr) != 0))  // AND there must still be data left in the file to read
+    // regular files are mapped and copied into memory in one go
+    // (segments don't start on page boundaries, so the file's pages can't be shared with memory's pages)
+    struct stat file_status;
+    if (fstat(file, &file_status) == 0 && S_ISREG(file_status.st_mode))
     {
-        memory-> template setWord<word>(curr_address, curr_instruction);
-        curr_address += 4;
+        size_t length = file_status.st_size - file_status.st_size % unit_size;  // a partial word at the end is ignored
+        if (length > capacity) { return false; }
+        if (length == 0) { return true; }
+
+        // private mapping, so swapping instructions copies only the pages it touches and never changes the file
+        byte *contents = (byte*) mmap(NULL, file_status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+        if (contents != MAP_FAILED)
+        {
+            madvise(contents, length, MADV_SEQUENTIAL);
+            if (swap) { toMemoryOrder(contents, length); }
+            memory->writeBlock(range.start, contents, length);
+            munmap(contents, file_status.st_size);
+            return true;
+        }
     }
 
-    if((curr_address+3 > interrupt_handler_address_range.end)
-       && (fread(&curr_instruction, sizeof(word), 1, interrupt_handler_ptr) != 0))  // if interrupt handler code doesn't fit inside memory space
+    // anything that can't be mapped is read in chunks instead
+    // (pipes and short reads can stop mid-word, so a partial word is kept for the next read and only ignored at the end)
+    word_size loaded = 0;
+    byte buffer[0x10000];
+    size_t buffered = 0;
+    ssize_t length;
+    while((length = read(file, buffer + buffered, sizeof(buffer) - buffered)) > 0)
     {
-        printf("Error: Interrupt handler cannot fit in allocated memory space\n");
-        return false;
+        buffered += length;
+        size_t whole = buffered - buffered % unit_size;
+        if (whole > capacity - loaded) { return false; }
+
+        if (swap) { toMemoryOrder(buffer, whole); }
+        memory->writeBlock(range.start + loaded, buffer, whole);
+        loaded += whole;
+        buffered -= whole;
+        memmove(buffer, buffer + whole, buffered);
     }
-
     return true;
 }
 
-template <typename word_size>
-void RISC_V<word_size>::debugger()
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::debugger()
 {
     for(;;)
     {
@@ -173,14 +213,8 @@ void RISC_V<word_size>::debugger()
         printf("\n      RISC-V CPU Debugger");
         printf("\n*******************************");
         printf("\nBase: %s\n", base.c_str());
-        printf("Extensions: ");
-        if(extensions != NULL)
-        {
-            for(Extension<word_size> *extension_ptr : ExtensionList<word_size> (*extensions))
-            printf("%s ", extension_ptr->getName().c_str());
-        }
-        else { printf("None"); }
-        printf("\n\nPC = 0x%llX\n\n", (double_word) pc->read());
+        printf("Extensions: %s", describeExtensions().c_str());
+        printf("\n\nPC = 0x%llX\n\n", (double_word) hart.pc);
         printf("Menu:\n");
         printf("1.) Read Registers\n");
         printf("2.) Read Memory\n");
@@ -218,8 +252,8 @@ void RISC_V<word_size>::debugger()
             case READ_REGISTERS:
                 for(byte i = 0; i < num_registers; i++)
                 {
-                    if(sizeof(word_size) <= 4) { printf("x%-2u = %08X%s", i, (word) register_set[i].read(), (i%8 == 7) ? "\n" : " | "); }
-                    else { printf("x%-2u = %016llX%s", i, (double_word) register_set[i].read(), (i%4 == 3) ? "\n" : " | "); }
+                    if(sizeof(word_size) <= 4) { printf("x%-2u = %08X%s", i, (word) hart.x[i], (i%8 == 7) ? "\n" : " | "); }
+                    else { printf("x%-2u = %016llX%s", i, (double_word) hart.x[i], (i%4 == 3) ? "\n" : " | "); }
                 }
                 printf("\n");
                 break;
@@ -237,7 +271,7 @@ void RISC_V<word_size>::debugger()
                 { 
                     printf(sizeof(word_size) <= 4 ? "%08X: " : "%016llX: ", start);
                     memory->printByte(start, false, HEX);
-                    byte data = memory->getByte(start);
+                    byte data = memory->peekByte(start);
                     printf("[%c]\n", (data >= ' ' && data <= '~') ? data : '.');
                 }
                 else { hexDump<word_size>(*memory, start, end); }  // print line(s) of bytes
@@ -270,18 +304,18 @@ void RISC_V<word_size>::debugger()
     }
 }
 
-template <typename word_size>
-void RISC_V<word_size>::fetch()
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::fetch()
 {
-    word_size address = pc->read();
+    word_size address = hart.pc;
     word instruction = memory-> template getWord<word>(address);
-    ir->write(instruction);
+    hart.ir = instruction;
 }
 
-template <typename word_size>
-dec_instr_t RISC_V<word_size>::decode()
+template <typename word_size, endian_t endian>
+dec_instr_t RISC_V<word_size, endian>::decode()
 {
-    word raw_instruction = ir->read();
+    word raw_instruction = hart.ir;
     byte opcode = raw_instruction & 127;  // retrieve opcode from least significant 7 bits
     dec_instr_t decoded_instruction;  // decoded instruction should be invalid by default
     switch(opcode)
@@ -291,15 +325,7 @@ dec_instr_t RISC_V<word_size>::decode()
             // If ARITH_LOG_R instruction doesn't exist in Base ISA (likely M instruction), check extensions
             if (decoded_instruction.funct7 != 0 && decoded_instruction.funct7 != 32)
             {
-                decoded_instruction.valid = false;
-                if(extensions != NULL) 
-                {
-                    byte idx = 0;
-                    while(idx < extensions->size() && !decoded_instruction.valid)
-                    {
-                        decoded_instruction = (extensions->at(idx++))->decode();
-                    }
-                }
+                decoded_instruction = decodeFromExtensions();
             }
             break;
         
@@ -329,14 +355,7 @@ dec_instr_t RISC_V<word_size>::decode()
         
         default:
             // opcode doesn't exist in base ISA; have extensions decode instruction instead
-            if(extensions != NULL) 
-            {
-                byte idx = 0;
-                while(idx < extensions->size() && !decoded_instruction.valid)
-                {
-                    decoded_instruction = (extensions->at(idx++))->decode();
-                }
-            }
+            decoded_instruction = decodeFromExtensions();
             break;
     }
 
@@ -344,594 +363,834 @@ dec_instr_t RISC_V<word_size>::decode()
     return decoded_instruction;
 }
 
-template <typename word_size>
-bool RISC_V<word_size>::execute(dec_instr_t instruction)
+template <typename word_size, endian_t endian>
+dec_instr_t RISC_V<word_size, endian>::decodeInstruction()
 {
-    // Invalid instructions are obviously not allowed to continue 
-    if (!instruction.valid) {
-        setInterruptFlag(II);
-        return false; 
+    dec_instr_t instruction = decode();
+    // handlers write rd without checking for x0, so x0 is left alone by giving them somewhere else to write
+    if (instruction.rd == 0) { instruction.rd = HartState<word_size>::SINK; }
+    return instruction;
+}
+
+template <typename word_size, endian_t endian>
+dec_instr_t RISC_V<word_size, endian>::fetchAndDecode()
+{
+    PackedInstruction<word_size, endian> *entry = getPredecoded(hart.pc);
+    if (entry == NULL)
+    {
+        fetch();
+        decoding_extension = NULL;
+        return decodeInstruction();
     }
 
-    // The user program is not allowed to modify the stack pointer
-    if (pc->read() >= program_address_range.start && pc->read() <= program_address_range.end && instruction.rd == 2)
+    hart.ir = entry->raw_instruction;
+    decoding_extension = entry->extension;
+    return DecodeCache<word_size, endian>::unpack(*entry);
+}
+
+template <typename word_size, endian_t endian>
+PackedInstruction<word_size, endian>* RISC_V<word_size, endian>::getPredecoded(word_size address)
+{
+    PackedInstruction<word_size, endian> *entry = decode_cache->find(address);
+    // devices can change what's read from their range without writing it, so instructions read from them aren't cached
+    if (entry == NULL || entry->filled) { return entry; }
+    if (memory->overlapsDevice(address, sizeof(word))) { return NULL; }
+
+    // decode() reads the instruction register, which is put back afterwards
+    word current_instruction = hart.ir;
+    hart.ir = memory-> template getWord<word>(address);
+    decoding_extension = NULL;
+    dec_instr_t decoded_instruction = decodeInstruction();
+    *entry = DecodeCache<word_size, endian>::pack(decoded_instruction, hart.ir, decoding_extension);
+    hart.ir = current_instruction;
+    return entry;
+}
+
+template <typename word_size, endian_t endian>
+BasicBlock<word_size, endian>* RISC_V<word_size, endian>::getBlock(word_size address)
+{
+    BasicBlock<word_size, endian> *block = decode_cache->findBlock(address);
+    if (block != NULL) { return block; }
+
+    // a block stays on one page, so writing that page drops it, and ends after its first branch, jump, or environment call
+    // (or an invalid instruction), since only those don't continue with the next instruction
+    block = new BasicBlock<word_size, endian>{address, {}, {{0, NULL}, {0, NULL}}, 0, NULL};
+    word_size page_number = address >> Memory<word_size, endian>::PAGE_BITS;
+    word_size instruction_address = address;
+    while ((instruction_address >> Memory<word_size, endian>::PAGE_BITS) == page_number)
     {
-        setInterruptFlag(MSP);
-        return false;
+        PackedInstruction<word_size, endian> *entry = getPredecoded(instruction_address);
+        if (entry == NULL) { break; }
+        dec_instr_t instruction = DecodeCache<word_size, endian>::unpack(*entry);
+        block->instructions.push_back({instruction, entry->raw_instruction, entry->extension, getHandler(instruction, instruction_address)});
+        instruction_address += sizeof(word);
+        if (endsBlock(entry->valid, entry->opcode)) { break; }
     }
 
-    // Execution was successful if instruction was found and sucessfully executed
-    bool success = true;
-    // count determines if pc should count after instruction is executed (pc should not count for jumps and successful branches)
-    bool count = true;
-    
-    switch (instruction.opcode)
+    if (block->instructions.empty())
     {
-        case ARITH_LOG_R:
-            switch(combineFunct(instruction.funct3, instruction.funct7))
+        delete block;
+        return NULL;
+    }
+    block->links[0].address = instruction_address;
+    decode_cache->addBlock(block);
+    return block;
+}
+
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::runBlocks()
+{
+    // translations are only thrown away here, where none of them is running
+    if (jit != NULL && jit->isFull())
+    {
+        decode_cache->clear();
+        jit->reset();
+    }
+    decode_cache->collectDroppedBlocks();  // none of them is running anymore
+    updateGuards();  // pc may have entered or left the user program since the last call
+
+    // code is only decoded ahead once it has been reached often enough for that to pay off
+    word_size address = hart.pc;
+    BasicBlock<word_size, endian> *block = decode_cache->findBlock(address);
+    if (block == NULL && tiers.predecoded && decode_cache->countEntry(address) >= tiers.predecode_threshold)
+    {
+        block = getBlock(address);
+    }
+    if (block == NULL)  // cold code, and instructions that can't be cached
+    {
+        interpretBlock();
+        return;
+    }
+
+    while (true)
+    {
+        word first = 0;  // the interpreter runs the block from here
+        if (block->native_code == NULL && jit != NULL && ++block->executions == tiers.native_threshold)
+        {
+            enterTier(NATIVE);  // translating counts toward the tier it's for
+            block->native_code = jit->compile(*block);
+        }
+        if (block->native_code != NULL)
+        {
+            enterTier(NATIVE);
+            native_block = block;
+            first = block->native_code();
+            native_block = NULL;
+            tier_instructions[NATIVE] += first;
+            if (hart.interrupt_flags != 0 || decode_cache->blocksDropped())
             {
-                case 0b0000000000:  // ADD
-                    alu->setOperand1(register_set[instruction.rs1].read());     // load rs1's value into ALU
-                    alu->operate(ADD, register_set[instruction.rs2].read());    // perform addition with rs2's value
-                    register_set[instruction.rd].write(alu->getResult());       // store result into rd
-                    break;
+                handleInterrupts();
+                return;
+            }
+        }
 
-                case 0b0000100000:  // SUB
-                    alu->setOperand1(register_set[instruction.rs1].read());     // load rs1's value into ALU
-                    alu->operate(SUB, register_set[instruction.rs2].read());    // perform subtraction with rs2's value
-                    register_set[instruction.rd].write(alu->getResult());       // store result into rd
-                    break;
+        if (first < block->instructions.size()) { enterTier(PREDECODED); }
+        for (word i = first; i < block->instructions.size(); i++)
+        {
+            BlockInstruction<word_size, endian> &block_instruction = block->instructions[i];
+            hart.ir = block_instruction.raw_instruction;
+            decoding_extension = block_instruction.extension;
+            if ((this->*block_instruction.handler)(block_instruction.instruction)) { hart.pc += sizeof(word); }
+            tier_instructions[PREDECODED]++;
+            // the rest of the block is stale if a store wrote code, and pc may have left it if an interrupt is pending
+            if (hart.interrupt_flags != 0 || decode_cache->blocksDropped())
+            {
+                handleInterrupts();
+                return;
+            }
+        }
 
-                case 0b0010000000:  // SLL
-                {
-                    // Only shift with the [log2(word_size)] least significant bits of rs2
-                    word_size shamt = register_set[instruction.rs2].read() & (sizeof(word_size)*8 - 1);  // calculate shift amount
-                    alu->setOperand1(register_set[instruction.rs1].read());                              // load rs1's value into ALU
-                    alu->operate(SLL, shamt);                                                            // perform logical left shift with rs2's value
-                    register_set[instruction.rd].write(alu->getResult());                                // store result into rd
-                    break;
-                }
+        // successors are chained to the block, so the cache is only searched when a block goes somewhere new (blocks that
+        // aren't formed yet are left to the next call, which counts how often they're reached)
+        word_size next_address = hart.pc;
+        if (isProgramAddress(next_address) != guards_active) { return; }  // the next call changes the guards first
+        typename BasicBlock<word_size, endian>::Link &link = (next_address == block->links[0].address) ? block->links[0] : block->links[1];
+        if (link.block == NULL || link.address != next_address)
+        {
+            BasicBlock<word_size, endian> *successor = decode_cache->findBlock(next_address);
+            if (successor == NULL) { return; }
+            link = {next_address, successor};
+        }
+        block = link.block;
+    }
+}
 
-                case 0b0100000000:  // SLT
-                    alu->setOperand1(register_set[instruction.rs1].read());  // load rs1's value into ALU
-                    alu->operate(LT, register_set[instruction.rs2].read());  // perform less than rs2's value
-                    register_set[instruction.rd].write(alu->getResult());    // store result into rd
-                    break;
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::interpretBlock()
+{
+    enterTier(INTERPRETER);
+    word_size page_number = hart.pc >> Memory<word_size, endian>::PAGE_BITS;
+    bool block_ended = false;
+    while (!block_ended)
+    {
+        fetch();
+        decoding_extension = NULL;
+        dec_instr_t instruction = decodeInstruction();
+        execute(instruction);
+        tier_instructions[INTERPRETER]++;
+        if (hart.interrupt_flags != 0)
+        {
+            handleInterrupts();
+            return;
+        }
+        // stopping where a block would start lets runBlocks() count how often that start is reached
+        block_ended = endsBlock(instruction.valid, instruction.opcode) || (hart.pc >> Memory<word_size, endian>::PAGE_BITS) != page_number;
+    }
+}
 
-                case 0b0110000000:  // SLTU
-                    alu->setOperand1(register_set[instruction.rs1].read());   // load rs1's value into ALU
-                    alu->operate(LTU, register_set[instruction.rs2].read());  // perform unsigned less than with rs2's value
-                    register_set[instruction.rd].write(alu->getResult());     // store result into rd
-                    break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::endsBlock(bool valid, byte opcode)
+{
+    return !valid || opcode == BRANCH || opcode == JAL || opcode == JALR || opcode == ENVIRONMENT;
+}
 
-                case 0b1000000000:  // XOR
-                    alu->setOperand1(register_set[instruction.rs1].read());   // load rs1's value into ALU
-                    alu->operate(XOR, register_set[instruction.rs2].read());  // perform bitwise XOR with rs2's value
-                    register_set[instruction.rd].write(alu->getResult());     // store result into rd
-                    break;
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::enterTier(execution_tier_t tier)
+{
+    if (tier == current_tier) { return; }
+    if (tiers.report)  // the clock is only read when the time is reported
+    {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        tier_seconds[current_tier] += std::chrono::duration<double>(now - tier_start).count();
+        tier_start = now;
+    }
+    current_tier = tier;
+}
 
-                case 0b1010000000:  // SRL
-                {
-                    // Only shift with the [log2(word_size)] least significant bits of rs2
-                    word_size shamt = register_set[instruction.rs2].read() & (sizeof(word_size)*8 - 1);  // calculate shift amount
-                    alu->setOperand1(register_set[instruction.rs1].read());                              // load rs1's value into ALU
-                    alu->operate(SRL, shamt);                                                            // perform logical right shift with rs2's value
-                    register_set[instruction.rd].write(alu->getResult());                                // store result into rd
-                    break;
-                }
-                
-                case 0b1010100000:  // SRA
-                {
-                    // Only shift with the [log2(word_size)] least significant bits of rs2
-                    word_size shamt = register_set[instruction.rs2].read() & (sizeof(word_size)*8 - 1);  // calculate shift amount
-                    alu->setOperand1(register_set[instruction.rs1].read());                              // load rs1's value into ALU
-                    alu->operate(SRA, shamt);                                                            // perform arithmetic right shift with rs2's value
-                    register_set[instruction.rd].write(alu->getResult());                                // store result into rd
-                    break;
-                }
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::reportTiers()
+{
+    tier_seconds[current_tier] += std::chrono::duration<double>(std::chrono::steady_clock::now() - tier_start).count();
+    const char *tier_names[NUM_TIERS] = {"interpreter", "predecoded", "native"};
+    const bool tier_active[NUM_TIERS] = {true, tiers.predecoded, jit != NULL};
 
-                case 0b1100000000:  // OR
-                    alu->setOperand1(register_set[instruction.rs1].read());  // load rs1's value into ALU
-                    alu->operate(OR, register_set[instruction.rs2].read());  // perform bitwise OR with rs2's value
-                    register_set[instruction.rd].write(alu->getResult());    // store result into rd
-                    break;
+    printf("\nExecution tiers:\n");
+    printf("%-11s  %14s  %10s  %10s\n", "Tier", "Instructions", "Time (s)", "MIPS");
+    for (int tier = INTERPRETER; tier < NUM_TIERS; tier++)
+    {
+        if (!tier_active[tier]) { printf("%-11s  %14s\n", tier_names[tier], "off"); }
+        else
+        {
+            printf("%-11s  %14llu  %10.3f  %10.1f\n", tier_names[tier], tier_instructions[tier], tier_seconds[tier],
+                   (tier_seconds[tier] > 0) ? tier_instructions[tier] / tier_seconds[tier] / 1e6 : 0.0);
+        }
+    }
+}
 
-                case 0b1110000000:  // AND
-                    alu->setOperand1(register_set[instruction.rs1].read());   // load rs1's value into ALU
-                    alu->operate(AND, register_set[instruction.rs2].read());  // perform bitwise AND with rs2's value
-                    register_set[instruction.rd].write(alu->getResult());     // store result into rd
-                    break;
+template <typename word_size, endian_t endian>
+template <typename data_size, typename extended_size>
+bool RISC_V<word_size, endian>::loadFromNativeCode(void *cpu, word_size instruction_address, word raw_instruction, word_size address,
+                                                   word_size rd)
+{
+    RISC_V<word_size, endian> *riscv = (RISC_V<word_size, endian>*) cpu;
+    riscv->hart.pc = instruction_address;  // in case the load raises an exception or faults
+    riscv->hart.ir = raw_instruction;
+    if (riscv->isRestrictedAccess(address)) { riscv->setInterruptFlag(SF); }
+    else { riscv->hart.x[rd] = (word_size) (extended_size) riscv->memory-> template load<data_size>(address); }
+    riscv->hart.pc += sizeof(word);
+    return riscv->hart.interrupt_flags != 0;
+}
 
-                default:
-                    // funct doesn't exist in base ISA; have extensions execute instruction instead
-                    success = executeFromExtensions(instruction);
-                    break;
-            }
-            break;
+template <typename word_size, endian_t endian>
+template <typename data_size>
+bool RISC_V<word_size, endian>::storeFromNativeCode(void *cpu, word_size instruction_address, word raw_instruction, word_size address,
+                                                    word_size value)
+{
+    RISC_V<word_size, endian> *riscv = (RISC_V<word_size, endian>*) cpu;
+    riscv->hart.pc = instruction_address;  // in case the store raises an exception or faults
+    riscv->hart.ir = raw_instruction;
+    if (riscv->isRestrictedAccess(address)) { riscv->setInterruptFlag(address == 0 ? SAZ : SF); }
+    else { riscv->memory-> template store<data_size>(address, value); }
+    riscv->hart.pc += sizeof(word);
+    return riscv->hart.interrupt_flags != 0 || riscv->decode_cache->blocksDropped();  // the store may have written code
+}
 
-        case ARITH_LOG_I:
-            switch(instruction.funct3)
-            {
-                case 0b000:  // ADDI
-                    alu->setOperand1(instruction.imm);                       // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());          // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());  // load rs1's value into ALU
-                    alu->operate(ADD, alu->getResult());                     // perform addition with sign ext'd imm
-                    register_set[instruction.rd].write(alu->getResult());    // store result into rd
-                    break;
+template <typename word_size, endian_t endian>
+dec_instr_t RISC_V<word_size, endian>::decodeFromExtensions()
+{
+    dec_instr_t decoded_instruction;  // stays invalid if no extension decodes the instruction
+    decoding_extension = NULL;
+    byte owner = findOwner(hart.ir);
+    if(owner != 0)
+    {
+        Extension<word_size, endian> *extension = extensions->at(owner - 1);
+        decoded_instruction = extension->decode();
+        if(decoded_instruction.valid) { decoding_extension = extension; }
+    }
+    return decoded_instruction;
+}
 
-                case 0b001:  // SLLI
-                {
-                    // Only shift with the [log2(word_size)] least significant bits of imm
-                    word_size shamt = instruction.imm & (sizeof(word_size)*8 - 1);  // calculate shift amount
-                    alu->setOperand1(register_set[instruction.rs1].read());         // load rs1's value into ALU
-                    alu->operate(SLL, shamt);                                       // perform logical left shift with imm
-                    register_set[instruction.rd].write(alu->getResult());           // store result into rd
-                    break;
-                }
+template <typename word_size, endian_t endian>
+std::string RISC_V<word_size, endian>::describeExtensions()
+{
+    if(extensions == NULL) { return "None"; }
+    std::string names;
+    for(Extension<word_size, endian> *extension : *extensions) { names += extension->getName() + " "; }
+    return names;
+}
 
-                case 0b010:  // SLTI
-                    alu->setOperand1(instruction.imm);                       // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());          // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());  // load rs1's value into ALU
-                    alu->operate(LT, alu->getResult());                      // perform less than with sign ext'd imm
-                    register_set[instruction.rd].write(alu->getResult());    // store result into rd
-                    break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::execute(dec_instr_t instruction)
+{
+    if ((this->*getHandler(instruction, hart.pc))(instruction)) { hart.pc += sizeof(word); }
+    return (hart.interrupt_flags & (II | MSP)) == 0;  // execution was successful unless the instruction wasn't allowed to run
+}
 
-                case 0b011:  // SLTIU
-                    alu->setOperand1(instruction.imm);                       // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());          // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());  // load rs1's value into ALU
-                    alu->operate(LTU, alu->getResult());                      // perform unsigned less than with sign ext'd imm
-                    register_set[instruction.rd].write(alu->getResult());    // store result into rd
-                    break;
+template <typename word_size, endian_t endian>
+byte RISC_V<word_size, endian>::funct7Class(byte funct7)
+{
+    // only the base ISA's and M's values of funct7 tell instructions apart
+    return (funct7 == 0b0000000) ? 0 : (funct7 == 0b0100000) ? 1 : (funct7 == 0b0000001) ? 2 : 3;
+}
 
-                case 0b100:  // XORI
-                    alu->setOperand1(instruction.imm);                       // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());          // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());  // load rs1's value into ALU
-                    alu->operate(XOR, alu->getResult());                     // perform bitwise XOR with sign ext'd imm
-                    register_set[instruction.rd].write(alu->getResult());    // store result into rd
-                    break;
+template <typename word_size, endian_t endian>
+word RISC_V<word_size, endian>::handlerIndex(byte opcode, byte funct3, byte funct7_class)
+{
+    return ((opcode >> 2) << 5) | (funct3 << 2) | funct7_class;  // the low two bits of 32-bit opcodes are always 11
+}
 
-                case 0b101:
-                {
-                    word_size shamt = instruction.imm & (sizeof(word_size)*8 - 1);  // calculate shift amount
-                    alu->setOperand1(register_set[instruction.rs1].read());         // load rs1's value into ALU
-                    if(((instruction.imm >> 10) & 1) == 0)  // SRLI
-                    {
-                        // Only shift with the [log2(word_size)] least significant bits of imm
-                        alu->operate(SRL, shamt);                                   // perform logical right shift with imm
-                    }
-                    else  // SRAI
-                    {
-                        // Only shift with the [log2(word_size)] least significant bits of imm
-                        alu->operate(SRA, shamt);                                   // perform arithmetic right shift with imm
-                    }
-                    register_set[instruction.rd].write(alu->getResult());           // store result into rd
-                    break;
-                }
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::setHandler(byte opcode, int funct3, int funct7, Handler handler)
+{
+    for (byte funct3_value = 0; funct3_value < 8; funct3_value++)
+    {
+        if (funct3 != ANY && funct3 != funct3_value) { continue; }
+        if (funct7 != ANY) { handlers[handlerIndex(opcode, funct3_value, funct7Class(funct7))] = handler; }
+        else
+        {
+            for (byte funct7_class = 0; funct7_class < 4; funct7_class++) { handlers[handlerIndex(opcode, funct3_value, funct7_class)] = handler; }
+        }
+    }
+}
 
-                case 0b110:  // ORI
-                    alu->setOperand1(instruction.imm);                       // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());          // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());  // load rs1's value into ALU
-                    alu->operate(OR, alu->getResult());                      // perform bitwise OR with sign ext'd imm
-                    register_set[instruction.rd].write(alu->getResult());    // store result into rd
-                    break;
+template <typename word_size, endian_t endian>
+typename RISC_V<word_size, endian>::Handler RISC_V<word_size, endian>::getHandler(const dec_instr_t &instruction, word_size address)
+{
+    // Invalid instructions are obviously not allowed to continue
+    if (!instruction.valid) { return &RISC_V::executeInvalid; }
 
-                case 0b111:  // ANDI
-                    alu->setOperand1(instruction.imm);                       // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());          // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());  // load rs1's value into ALU
-                    alu->operate(AND, alu->getResult());                     // perform bitwise AND with sign ext'd imm
-                    register_set[instruction.rd].write(alu->getResult());    // store result into rd
-                    break;
-            }
-            break;
+    // The user program is not allowed to modify the stack pointer (rd is tested first since it rarely is sp)
+    if (instruction.rd == 2 && address >= program_address_range.start && address <= program_address_range.end)
+    {
+        return &RISC_V::executeStackPointerWrite;
+    }
 
-        case LOAD:
-            switch(instruction.funct3)
-            {
-                case 0b000:  // LB
-                    alu->setOperand1(instruction.imm);                         // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());            // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());    // load rs1's value into ALU
-                    alu->operate(ADD, alu->getResult());                       // add rs1's value with sign ext'd imm
-                    // check if user program is attempting to access restricted memory
-                    if ((pc->read() >= program_address_range.start && pc->read() <= program_address_range.end) &&
-                        (alu->getResult() < program_address_range.start || alu->getResult() > program_address_range.end) &&
-                        (alu->getResult() < global_data_address_range.start || alu->getResult() > global_data_address_range.end))
-                    {
-                        setInterruptFlag(SF);
-                    }
-                    else
-                    { 
-                        alu->setOperand1(memory->getByte(alu->getResult()));   // load byte from memory into ALU
-                        alu->operate(SXT, constants->at(0x80).read());         // sign extend byte
-                        register_set[instruction.rd].write(alu->getResult());  // store sign ext'd byte into rd
-                    }
-                    break;
+    if ((instruction.opcode & 0b11) != 0b11) { return extension_handler; }  // isn't a 32-bit instruction
+    return handlers[handlerIndex(instruction.opcode, instruction.funct3, funct7Class(instruction.funct7))];
+}
 
-                case 0b001:  // LH
-                    alu->setOperand1(instruction.imm);                           // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());              // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());      // load rs1's value into ALU
-                    alu->operate(ADD, alu->getResult());                         // add rs1's value with sign ext'd imm
-                    // check if user program is attempting to access restricted memory
-                    if ((pc->read() >= program_address_range.start && pc->read() <= program_address_range.end) &&
-                        (alu->getResult() < program_address_range.start || alu->getResult() > program_address_range.end) &&
-                        (alu->getResult() < global_data_address_range.start || alu->getResult() > global_data_address_range.end))
-                    {
-                        setInterruptFlag(SF);
-                    }
-                    else
-                    {
-                        alu->setOperand1(memory->                                // load half word from memory into ALU
-                            template getWord<half_word>(alu->getResult()));  
-                        alu->operate(SXT, constants->at(0x8000).read());         // sign extend half word
-                        register_set[instruction.rd].write(alu->getResult());    // store sign ext'd half word into rd
-                    }
-                    break;
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::setBaseHandlers()
+{
+    // whatever the base ISA doesn't have is left to the extensions
+    extension_handler = &RISC_V::executeByExtension;
+    handlers.assign(32 * 8 * 4, extension_handler);
+    setHandler(ARITH_LOG_R, 0b000, 0b0000000, &RISC_V::executeADD);
+    setHandler(ARITH_LOG_R, 0b000, 0b0100000, &RISC_V::executeSUB);
+    setHandler(ARITH_LOG_R, 0b001, 0b0000000, &RISC_V::executeSLL);
+    setHandler(ARITH_LOG_R, 0b010, 0b0000000, &RISC_V::executeSLT);
+    setHandler(ARITH_LOG_R, 0b011, 0b0000000, &RISC_V::executeSLTU);
+    setHandler(ARITH_LOG_R, 0b100, 0b0000000, &RISC_V::executeXOR);
+    setHandler(ARITH_LOG_R, 0b101, 0b0000000, &RISC_V::executeSRL);
+    setHandler(ARITH_LOG_R, 0b101, 0b0100000, &RISC_V::executeSRA);
+    setHandler(ARITH_LOG_R, 0b110, 0b0000000, &RISC_V::executeOR);
+    setHandler(ARITH_LOG_R, 0b111, 0b0000000, &RISC_V::executeAND);
+    setHandler(ARITH_LOG_I, 0b000, ANY,       &RISC_V::executeADDI);
+    setHandler(ARITH_LOG_I, 0b001, ANY,       &RISC_V::executeSLLI);
+    setHandler(ARITH_LOG_I, 0b010, ANY,       &RISC_V::executeSLTI);
+    setHandler(ARITH_LOG_I, 0b011, ANY,       &RISC_V::executeSLTIU);
+    setHandler(ARITH_LOG_I, 0b100, ANY,       &RISC_V::executeXORI);
+    setHandler(ARITH_LOG_I, 0b101, ANY,       &RISC_V::executeShiftRightImmediate);
+    setHandler(ARITH_LOG_I, 0b110, ANY,       &RISC_V::executeORI);
+    setHandler(ARITH_LOG_I, 0b111, ANY,       &RISC_V::executeANDI);
+    setHandler(LOAD,        0b000, ANY,       &RISC_V::executeLB);
+    setHandler(LOAD,        0b001, ANY,       &RISC_V::executeLH);
+    setHandler(LOAD,        0b010, ANY,       &RISC_V::executeLW);
+    setHandler(LOAD,        0b100, ANY,       &RISC_V::executeLBU);
+    setHandler(LOAD,        0b101, ANY,       &RISC_V::executeLHU);
+    setHandler(STORE,       0b000, ANY,       &RISC_V::executeSB);
+    setHandler(STORE,       0b001, ANY,       &RISC_V::executeSH);
+    setHandler(STORE,       0b010, ANY,       &RISC_V::executeSW);
+    setHandler(BRANCH,      0b000, ANY,       &RISC_V::executeBEQ);
+    setHandler(BRANCH,      0b001, ANY,       &RISC_V::executeBNE);
+    setHandler(BRANCH,      0b100, ANY,       &RISC_V::executeBLT);
+    setHandler(BRANCH,      0b101, ANY,       &RISC_V::executeBGE);
+    setHandler(BRANCH,      0b110, ANY,       &RISC_V::executeBLTU);
+    setHandler(BRANCH,      0b111, ANY,       &RISC_V::executeBGEU);
+    setHandler(JAL,         ANY,   ANY,       &RISC_V::executeJAL);
+    setHandler(JALR,        0b000, ANY,       &RISC_V::executeJALR);
+    setHandler(LUI,         ANY,   ANY,       &RISC_V::executeLUI);
+    setHandler(AUIPC,       ANY,   ANY,       &RISC_V::executeAUIPC);
+    setHandler(ENVIRONMENT, 0b000, ANY,       &RISC_V::executeEnvironment);
+}
 
-                case 0b010:  // LW
-                    alu->setOperand1(instruction.imm);                           // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());              // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());      // load rs1's value into ALU
-                    alu->operate(ADD, alu->getResult());                         // add rs1's value with sign ext'd imm
-                    // check if user program is attempting to access restricted memory
-                    if ((pc->read() >= program_address_range.start && pc->read() <= program_address_range.end) &&
-                        (alu->getResult() < program_address_range.start || alu->getResult() > program_address_range.end) &&
-                        (alu->getResult() < global_data_address_range.start || alu->getResult() > global_data_address_range.end))
-                    {
-                        setInterruptFlag(SF);
-                    }
-                    else
-                    {
-                        alu->setOperand1(memory->                                // load word from memory into ALU
-                            template getWord<word>(alu->getResult()));  
-                        alu->operate(SXT, constants->at(0x80000000).read());     // sign extend word (useful for RV64 and RV128)
-                        register_set[instruction.rd].write(alu->getResult());    // store sign ext'd word into rd
-                    }
-                    break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeByExtension(dec_instr_t instruction)
+{
+    if (executeFromExtensions(instruction)) { return true; }
+    setInterruptFlag(II);
+    return false;
+}
 
-                case 0b100:  // LBU
-                    alu->setOperand1(instruction.imm);                                              // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());                                 // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());                         // load rs1's value into ALU
-                    alu->operate(ADD, alu->getResult());                                            // add rs1's value with sign ext'd imm
-                    // check if user program is attempting to access restricted memory
-                    if ((pc->read() >= program_address_range.start && pc->read() <= program_address_range.end) &&
-                        (alu->getResult() < program_address_range.start || alu->getResult() > program_address_range.end) &&
-                        (alu->getResult() < global_data_address_range.start || alu->getResult() > global_data_address_range.end))
-                    {
-                        setInterruptFlag(SF);
-                    }
-                    else
-                        { register_set[instruction.rd].write(memory->getByte(alu->getResult())); }  // load zero ext'd byte from memory into rd
-                    break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeInvalid(dec_instr_t)
+{
+    setInterruptFlag(II);
+    return false;
+}
 
-                case 0b101:  // LHU
-                    alu->setOperand1(instruction.imm);                                          // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());                             // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());                     // load rs1's value into ALU
-                    alu->operate(ADD, alu->getResult());                                        // add rs1's value with sign ext'd imm
-                    // check if user program is attempting to access restricted memory
-                    if ((pc->read() >= program_address_range.start && pc->read() <= program_address_range.end) &&
-                        (alu->getResult() < program_address_range.start || alu->getResult() > program_address_range.end) &&
-                        (alu->getResult() < global_data_address_range.start || alu->getResult() > global_data_address_range.end))
-                    {
-                        setInterruptFlag(SF);
-                    }
-                    else
-                    { 
-                        register_set[instruction.rd].write(memory->                             // load zero ext'd half word from memory into rd
-                            template getWord<half_word>(alu->getResult()));
-                    }
-                    break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeStackPointerWrite(dec_instr_t)
+{
+    setInterruptFlag(MSP);
+    return false;
+}
 
-                default:
-                    // funct doesn't exist in base ISA; have extensions execute instruction instead
-                    success = executeFromExtensions(instruction);
-                    break;
-            }
-            break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeADD(dec_instr_t instruction)
+{
+    // Add rs2's value to rs1's value
+    hart.x[instruction.rd] = hart.x[instruction.rs1] + hart.x[instruction.rs2];
+    return true;
+}
 
-        case STORE:
-            switch(instruction.funct3)
-            {
-                case 0b000:  // SB
-                    alu->setOperand1(instruction.imm);                                                // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());                                   // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());                           // load rs1's value into ALU
-                    alu->operate(ADD, alu->getResult());                                              // add rs1's value with sign ext'd imm
-                    // check if user program is attempting to access restricted memory
-                    if ((pc->read() >= program_address_range.start && pc->read() <= program_address_range.end) &&
-                        (alu->getResult() < program_address_range.start || alu->getResult() > program_address_range.end) &&
-                        (alu->getResult() < global_data_address_range.start || alu->getResult() > global_data_address_range.end))
-                    {
-                        setInterruptFlag(alu->getResult() == 0 ? SAZ : SF);
-                    }
-                    else
-                        { memory->setByte(alu->getResult(), register_set[instruction.rs2].read()); }  // store LS byte of rs2's value into memory
-                    break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeSUB(dec_instr_t instruction)
+{
+    // Subtract rs2's value from rs1's value
+    hart.x[instruction.rd] = hart.x[instruction.rs1] - hart.x[instruction.rs2];
+    return true;
+}
 
-                case 0b001:  // SH
-                    alu->setOperand1(instruction.imm);                                 // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());                    // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());            // load rs1's value into ALU
-                    alu->operate(ADD, alu->getResult());                               // add rs1's value with sign ext'd imm
-                    // check if user program is attempting to access restricted memory
-                    if ((pc->read() >= program_address_range.start && pc->read() <= program_address_range.end) &&
-                        (alu->getResult() < program_address_range.start || alu->getResult() > program_address_range.end) &&
-                        (alu->getResult() < global_data_address_range.start || alu->getResult() > global_data_address_range.end))
-                    {
-                        setInterruptFlag(alu->getResult() == 0 ? SAZ : SF);
-                    }
-                    else
-                    {
-                        memory-> template setWord<half_word>                           // store LS half word of rs2's value into memory
-                            (alu->getResult(), register_set[instruction.rs2].read());  
-                    }
-                    break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeSLL(dec_instr_t instruction)
+{
+    // Only shift with the [log2(word_size)] least significant bits of rs2
+    byte shamt = hart.x[instruction.rs2] & (sizeof(word_size)*8 - 1);
+    hart.x[instruction.rd] = hart.x[instruction.rs1] << shamt;
+    return true;
+}
 
-                case 0b010:  // SW
-                    alu->setOperand1(instruction.imm);                                 // load immediate into ALU
-                    alu->operate(SXT, constants->at(0x800).read());                    // sign extend imm by bit 11
-                    alu->setOperand1(register_set[instruction.rs1].read());            // load rs1's value into ALU
-                    alu->operate(ADD, alu->getResult());                               // add rs1's value with sign ext'd imm
-                    // check if user program is attempting to access restricted memory
-                    if ((pc->read() >= program_address_range.start && pc->read() <= program_address_range.end) &&
-                        (alu->getResult() < program_address_range.start || alu->getResult() > program_address_range.end) &&
-                        (alu->getResult() < global_data_address_range.start || alu->getResult() > global_data_address_range.end))
-                    {
-                        setInterruptFlag(alu->getResult() == 0 ? SAZ : SF);
-                    }
-                    else
-                    {
-                        memory-> template setWord<word>                                // store LS word of rs2's value into memory
-                            (alu->getResult(), register_set[instruction.rs2].read());  
-                    }
-                    break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeSLT(dec_instr_t instruction)
+{
+    // Signed compare with rs2's value
+    hart.x[instruction.rd] = (s_word_size) hart.x[instruction.rs1] < (s_word_size) hart.x[instruction.rs2];
+    return true;
+}
 
-                default:
-                    // funct doesn't exist in base ISA; have extensions execute instruction instead
-                    success = executeFromExtensions(instruction);
-                    break;
-            }
-            break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeSLTU(dec_instr_t instruction)
+{
+    // Unsigned compare with rs2's value
+    hart.x[instruction.rd] = hart.x[instruction.rs1] < hart.x[instruction.rs2];
+    return true;
+}
 
-        case BRANCH:
-            switch (instruction.funct3)
-            {
-                case 0b000:  // BEQ
-                    alu->setOperand1(register_set[instruction.rs1].read());  // load rs1's value into ALU
-                    alu->operate(EQ, register_set[instruction.rs2].read());  // check if equal to rs2's value
-                    count = !alu->getResult();                               // pc should not count if branch is successful
-                    alu->setOperand1(alu->getResult());                      // load comparison result into ALU
-                    alu->operate(SXT, alu->getResult());                     // produces either all zeros or all ones
-                    alu->setOperand1(instruction.imm);                       // load immediate into ALU
-                    alu->operate(AND, alu->getResult());                     // perform bitwise AND with bitmask to determine branch
-                    alu->setOperand1(alu->getResult());                      // load branch amount into ALU
-                    alu->operate(SXT, constants->at(0x1000).read());         // sign extend branch amount by bit 12
-                    alu->setOperand1(alu->getResult());                      // load sign ext'd branch about into ALU
-                    alu->operate(ADD, pc->read());                           // add branch amount with address in pc
-                    pc->write(alu->getResult());                             // write branch address into pc
-                    break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeXOR(dec_instr_t instruction)
+{
+    // Bitwise XOR with rs2's value
+    hart.x[instruction.rd] = hart.x[instruction.rs1] ^ hart.x[instruction.rs2];
+    return true;
+}
 
-                case 0b001:  // BNE
-                    alu->setOperand1(register_set[instruction.rs1].read());   // load rs1's value into ALU
-                    alu->operate(NEQ, register_set[instruction.rs2].read());  // check if not equal to rs2's value
-                    count = !alu->getResult();                                // pc should not count if branch is successful
-                    alu->setOperand1(alu->getResult());                       // load comparison result into ALU
-                    alu->operate(SXT, alu->getResult());                      // produces either all zeros or all ones
-                    alu->setOperand1(instruction.imm);                        // load immediate into ALU
-                    alu->operate(AND, alu->getResult());                      // perform bitwise AND with bitmask to determine branch
-                    alu->setOperand1(alu->getResult());                       // load branch amount into ALU
-                    alu->operate(SXT, constants->at(0x1000).read());          // sign extend branch amount by bit 12
-                    alu->setOperand1(alu->getResult());                       // load sign ext'd branch about into ALU
-                    alu->operate(ADD, pc->read());                            // add branch amount with address in pc
-                    pc->write(alu->getResult());                              // write branch address into pc
-                    break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeSRL(dec_instr_t instruction)
+{
+    // Only shift with the [log2(word_size)] least significant bits of rs2
+    byte shamt = hart.x[instruction.rs2] & (sizeof(word_size)*8 - 1);
+    hart.x[instruction.rd] = hart.x[instruction.rs1] >> shamt;
+    return true;
+}
 
-                case 0b100:  // BLT
-                    alu->setOperand1(register_set[instruction.rs1].read());  // load rs1's value into ALU
-                    alu->operate(LT, register_set[instruction.rs2].read());  // check if less than rs2's value
-                    count = !alu->getResult();                               // pc should not count if branch is successful
-                    alu->setOperand1(alu->getResult());                      // load comparison result into ALU
-                    alu->operate(SXT, alu->getResult());                     // produces either all zeros or all ones
-                    alu->setOperand1(instruction.imm);                       // load immediate into ALU
-                    alu->operate(AND, alu->getResult());                     // perform bitwise AND with bitmask to determine branch
-                    alu->setOperand1(alu->getResult());                      // load branch amount into ALU
-                    alu->operate(SXT, constants->at(0x1000).read());         // sign extend branch amount by bit 12
-                    alu->setOperand1(alu->getResult());                      // load sign ext'd branch about into ALU
-                    alu->operate(ADD, pc->read());                           // add branch amount with address in pc
-                    pc->write(alu->getResult());                             // write branch address into pc
-                    break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeSRA(dec_instr_t instruction)
+{
+    // Only shift with the [log2(word_size)] least significant bits of rs2
+    byte shamt = hart.x[instruction.rs2] & (sizeof(word_size)*8 - 1);
+    hart.x[instruction.rd] = (word_size) ((s_word_size) hart.x[instruction.rs1] >> shamt);
+    return true;
+}
 
-                case 0b101:  // BGE
-                    alu->setOperand1(register_set[instruction.rs1].read());  // load rs1's value into ALU
-                    alu->operate(GE, register_set[instruction.rs2].read());  // check if greater than or equal to rs2's value
-                    count = !alu->getResult();                               // pc should not count if branch is successful
-                    alu->setOperand1(alu->getResult());                      // load comparison result into ALU
-                    alu->operate(SXT, alu->getResult());                     // produces either all zeros or all ones
-                    alu->setOperand1(instruction.imm);                       // load immediate into ALU
-                    alu->operate(AND, alu->getResult());                     // perform bitwise AND with bitmask to determine branch
-                    alu->setOperand1(alu->getResult());                      // load branch amount into ALU
-                    alu->operate(SXT, constants->at(0x1000).read());         // sign extend branch amount by bit 12
-                    alu->setOperand1(alu->getResult());                      // load sign ext'd branch about into ALU
-                    alu->operate(ADD, pc->read());                           // add branch amount with address in pc
-                    pc->write(alu->getResult());                             // write branch address into pc
-                    break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeOR(dec_instr_t instruction)
+{
+    // Bitwise OR with rs2's value
+    hart.x[instruction.rd] = hart.x[instruction.rs1] | hart.x[instruction.rs2];
+    return true;
+}
 
-                case 0b110:  // BLTU
-                    alu->setOperand1(register_set[instruction.rs1].read());   // load rs1's value into ALU
-                    alu->operate(LTU, register_set[instruction.rs2].read());  // check if unsigned less than rs2's value
-                    count = !alu->getResult();                                // pc should not count if branch is successful
-                    alu->setOperand1(alu->getResult());                       // load comparison result into ALU
-                    alu->operate(SXT, alu->getResult());                      // produces either all zeros or all ones
-                    alu->setOperand1(instruction.imm);                        // load immediate into ALU
-                    alu->operate(AND, alu->getResult());                      // perform bitwise AND with bitmask to determine branch
-                    alu->setOperand1(alu->getResult());                       // load branch amount into ALU
-                    alu->operate(SXT, constants->at(0x1000).read());          // sign extend branch amount by bit 12
-                    alu->setOperand1(alu->getResult());                       // load sign ext'd branch about into ALU
-                    alu->operate(ADD, pc->read());                            // add branch amount with address in pc
-                    pc->write(alu->getResult());                              // write branch address into pc
-                    break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeAND(dec_instr_t instruction)
+{
+    // Bitwise AND with rs2's value
+    hart.x[instruction.rd] = hart.x[instruction.rs1] & hart.x[instruction.rs2];
+    return true;
+}
 
-                case 0b111:  // BGEU
-                    alu->setOperand1(register_set[instruction.rs1].read());   // load rs1's value into ALU
-                    alu->operate(GEU, register_set[instruction.rs2].read());  // check if unsigned greater than or equal to rs2's value
-                    count = !alu->getResult();                                // pc should not count if branch is successful
-                    alu->setOperand1(alu->getResult());                       // load comparison result into ALU
-                    alu->operate(SXT, alu->getResult());                      // produces either all zeros or all ones
-                    alu->setOperand1(instruction.imm);                        // load immediate into ALU
-                    alu->operate(AND, alu->getResult());                      // perform bitwise AND with bitmask to determine branch
-                    alu->setOperand1(alu->getResult());                       // load branch amount into ALU
-                    alu->operate(SXT, constants->at(0x1000).read());          // sign extend branch amount by bit 12
-                    alu->setOperand1(alu->getResult());                       // load sign ext'd branch about into ALU
-                    alu->operate(ADD, pc->read());                            // add branch amount with address in pc
-                    pc->write(alu->getResult());                              // write branch address into pc
-                    break;
-                
-                default:
-                    // funct doesn't exist in base ISA; have extensions execute instruction instead
-                    success = executeFromExtensions(instruction);
-                    break;
-            }
-            break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeADDI(dec_instr_t instruction)
+{
+    // Add sign ext'd imm to rs1's value
+    hart.x[instruction.rd] = hart.x[instruction.rs1] + (word_size) instruction.imm;
+    return true;
+}
 
-        case JAL:  // JAL
-            alu->setOperand1(instruction.imm);                  // load immediate into ALU
-            alu->operate(SXT, constants->at(0x100000).read());  // sign extend imm by bit 20
-            alu->setOperand1(alu->getResult());                 // load sign ext'd imm into ALU
-            alu->operate(ADD, pc->read());                      // add offset to pc
-            pc->count();                                        // count to next instruction
-            register_set[instruction.rd].write(pc->read());     // store address after jump instruction into rd
-            pc->write(alu->getResult());                        // jump to new address
-            count = register_set[0].read();                     // pc should not count after instruction is executed
-            break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeSLLI(dec_instr_t instruction)
+{
+    // Only shift with the [log2(word_size)] least significant bits of imm
+    byte shamt = instruction.imm & (sizeof(word_size)*8 - 1);
+    hart.x[instruction.rd] = hart.x[instruction.rs1] << shamt;
+    return true;
+}
 
-        case JALR:
-            switch (instruction.funct3)
-            {
-                case 0b000:  // JALR
-                    alu->operate(GEU, register_set[0].read());                // generate a 1 (every unsigned number is >= 0)
-                    alu->operate(NOT, alu->getResult());                      // generate ...111110
-                    alu->setOperand1(alu->getResult());                       // load bitmask into ALU
-                    alu->operate(AND, instruction.imm);                       // set bit 0 of immediate to 0
-                    alu->setOperand1(alu->getResult());                       // load aligned imm into ALU
-                    alu->operate(SXT, constants->at(0x800).read());           // sign extend aligned imm by bit 11
-                    alu->setOperand1(alu->getResult());                       // load sign ext'd aligned imm into ALU
-                    alu->operate(ADD, register_set[instruction.rs1].read());  // add offset to rs1's value
-                    pc->count();                                              // count to next instruction
-                    register_set[instruction.rd].write(pc->read());           // store address after jump instruction into rd
-                    pc->write(alu->getResult());                              // jump to new address
-                    count = register_set[0].read();                           // pc should not count after instruction is executed
-                    break;
-                
-                default:
-                    // funct doesn't exist in base ISA; have extensions execute instruction instead
-                    success = executeFromExtensions(instruction);
-                    break;
-            }
-            break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeSLTI(dec_instr_t instruction)
+{
+    // Signed compare with sign ext'd imm
+    hart.x[instruction.rd] = (s_word_size) hart.x[instruction.rs1] < (s_word_size) instruction.imm;
+    return true;
+}
 
-        case LUI:  // LUI
-            alu->setOperand1(instruction.imm);                     // load immediate into ALU
-            alu->operate(SXT, constants->at(0x80000000).read());   // sign extend imm by bit 31 (useful for RV64 and RV128)
-            register_set[instruction.rd].write(alu->getResult());  // store sign ext'd imm into rd
-            break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeSLTIU(dec_instr_t instruction)
+{
+    // Unsigned compare with sign ext'd imm
+    hart.x[instruction.rd] = hart.x[instruction.rs1] < (word_size) instruction.imm;
+    return true;
+}
 
-        case AUIPC:  // AUIPC
-            alu->setOperand1(instruction.imm);                     // load immediate into ALU
-            alu->operate(SXT, constants->at(0x80000000).read());   // sign extend imm by bit 31 (useful for RV64 and RV128)
-            alu->setOperand1(alu->getResult());                    // load sign ext'd imm into ALU
-            alu->operate(ADD, pc->read());                         // add offset to pc's value
-            register_set[instruction.rd].write(alu->getResult());  // store new address in rd
-            break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeXORI(dec_instr_t instruction)
+{
+    // Bitwise XOR with sign ext'd imm
+    hart.x[instruction.rd] = hart.x[instruction.rs1] ^ (word_size) instruction.imm;
+    return true;
+}
 
-        case ENVIRONMENT:
-            switch (instruction.funct3)
-            {
-            case 0b000:
-                if((instruction.imm & 1) == 0)  // ECALL
-                {
-                    setInterruptFlag(EC);
-                }
-                else  // EBREAK
-                {
-                    setInterruptFlag(EB);
-                    count = false;  // pc will count after interrupt handler handles debugger
-                }
-                break;
-            
-            default:
-                // funct doesn't exist in base ISA; have extensions execute instruction instead
-                success = executeFromExtensions(instruction);
-                break;
-            }
-            break;
-        
-        default:
-            // opcode doesn't exist in base ISA; have extensions execute instruction instead
-            success = executeFromExtensions(instruction);
-            break;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeShiftRightImmediate(dec_instr_t instruction)
+{
+    // Only shift with the [log2(word_size)] least significant bits of imm
+    byte shamt = instruction.imm & (sizeof(word_size)*8 - 1);
+    if(((instruction.imm >> 10) & 1) == 0)  // SRLI
+    {
+        hart.x[instruction.rd] = hart.x[instruction.rs1] >> shamt;
+    }
+    else  // SRAI
+    {
+        hart.x[instruction.rd] = (word_size) ((s_word_size) hart.x[instruction.rs1] >> shamt);
     }
+    return true;
+}
 
-    if(success && count) { pc->count(); }
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeORI(dec_instr_t instruction)
+{
+    // Bitwise OR with sign ext'd imm
+    hart.x[instruction.rd] = hart.x[instruction.rs1] | (word_size) instruction.imm;
+    return true;
+}
 
-    if (!success) { setInterruptFlag(II); }
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeANDI(dec_instr_t instruction)
+{
+    // Bitwise AND with sign ext'd imm
+    hart.x[instruction.rd] = hart.x[instruction.rs1] & (word_size) instruction.imm;
+    return true;
+}
 
-    return success;
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeLB(dec_instr_t instruction)
+{
+    word_size address = hart.x[instruction.rs1] + (word_size) instruction.imm;  // rs1's value plus imm
+    // check if user program is attempting to access restricted memory
+    if (isRestrictedAccess(address))
+    {
+        setInterruptFlag(SF);
+    }
+    else
+    {
+        hart.x[instruction.rd] = (word_size) (s_byte) memory-> template load<byte>(address);  // load sign ext'd byte into rd
+    }
+    return true;
 }
 
-template <typename word_size>
-bool RISC_V<word_size>::executeFromExtensions(dec_instr_t instruction)
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeLH(dec_instr_t instruction)
 {
-    if(extensions != NULL) 
+    word_size address = hart.x[instruction.rs1] + (word_size) instruction.imm;  // rs1's value plus imm
+    // check if user program is attempting to access restricted memory
+    if (isRestrictedAccess(address))
     {
-        byte idx = 0;
-        bool success = false;
-        while(idx < extensions->size() && !success)
-        {
-            success = (extensions->at(idx++))->execute(instruction);
-        }
-        return success;
+        setInterruptFlag(SF);
+    }
+    else
+    {
+        hart.x[instruction.rd] = (word_size) (s_half_word) memory-> template load<half_word>(address);  // load sign ext'd half word into rd
+    }
+    return true;
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeLW(dec_instr_t instruction)
+{
+    word_size address = hart.x[instruction.rs1] + (word_size) instruction.imm;  // rs1's value plus imm
+    // check if user program is attempting to access restricted memory
+    if (isRestrictedAccess(address))
+    {
+        setInterruptFlag(SF);
+    }
+    else
+    {
+        hart.x[instruction.rd] = (word_size) (s_word) memory-> template load<word>(address);  // load sign ext'd word into rd (useful for RV64 and RV128)
+    }
+    return true;
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeLBU(dec_instr_t instruction)
+{
+    word_size address = hart.x[instruction.rs1] + (word_size) instruction.imm;  // rs1's value plus imm
+    // check if user program is attempting to access restricted memory
+    if (isRestrictedAccess(address))
+    {
+        setInterruptFlag(SF);
+    }
+    else
+    {
+        hart.x[instruction.rd] = memory-> template load<byte>(address);  // load zero ext'd byte into rd
+    }
+    return true;
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeLHU(dec_instr_t instruction)
+{
+    word_size address = hart.x[instruction.rs1] + (word_size) instruction.imm;  // rs1's value plus imm
+    // check if user program is attempting to access restricted memory
+    if (isRestrictedAccess(address))
+    {
+        setInterruptFlag(SF);
+    }
+    else
+    {
+        hart.x[instruction.rd] = memory-> template load<half_word>(address);  // load zero ext'd half word into rd
+    }
+    return true;
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeSB(dec_instr_t instruction)
+{
+    word_size address = hart.x[instruction.rs1] + (word_size) instruction.imm;  // rs1's value plus imm
+    // check if user program is attempting to access restricted memory
+    if (isRestrictedAccess(address))
+    {
+        setInterruptFlag(address == 0 ? SAZ : SF);
+    }
+    else
+    {
+        memory-> template store<byte>(address, hart.x[instruction.rs2]);  // store LS byte of rs2's value
+    }
+    return true;
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeSH(dec_instr_t instruction)
+{
+    word_size address = hart.x[instruction.rs1] + (word_size) instruction.imm;  // rs1's value plus imm
+    // check if user program is attempting to access restricted memory
+    if (isRestrictedAccess(address))
+    {
+        setInterruptFlag(address == 0 ? SAZ : SF);
+    }
+    else
+    {
+        memory-> template store<half_word>(address, hart.x[instruction.rs2]);  // store LS half word of rs2's value
+    }
+    return true;
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeSW(dec_instr_t instruction)
+{
+    word_size address = hart.x[instruction.rs1] + (word_size) instruction.imm;  // rs1's value plus imm
+    // check if user program is attempting to access restricted memory
+    if (isRestrictedAccess(address))
+    {
+        setInterruptFlag(address == 0 ? SAZ : SF);
+    }
+    else
+    {
+        memory-> template store<word>(address, hart.x[instruction.rs2]);  // store LS word of rs2's value
+    }
+    return true;
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeBEQ(dec_instr_t instruction)
+{
+    bool taken = hart.x[instruction.rs1] == hart.x[instruction.rs2];
+    if (taken) { hart.pc += (word_size) instruction.imm; }  // branch relative to the branch instruction
+    return !taken;                                          // pc should not count if branch is successful
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeBNE(dec_instr_t instruction)
+{
+    bool taken = hart.x[instruction.rs1] != hart.x[instruction.rs2];
+    if (taken) { hart.pc += (word_size) instruction.imm; }  // branch relative to the branch instruction
+    return !taken;                                          // pc should not count if branch is successful
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeBLT(dec_instr_t instruction)
+{
+    bool taken = (s_word_size) hart.x[instruction.rs1] < (s_word_size) hart.x[instruction.rs2];
+    if (taken) { hart.pc += (word_size) instruction.imm; }  // branch relative to the branch instruction
+    return !taken;                                          // pc should not count if branch is successful
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeBGE(dec_instr_t instruction)
+{
+    bool taken = (s_word_size) hart.x[instruction.rs1] >= (s_word_size) hart.x[instruction.rs2];
+    if (taken) { hart.pc += (word_size) instruction.imm; }  // branch relative to the branch instruction
+    return !taken;                                          // pc should not count if branch is successful
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeBLTU(dec_instr_t instruction)
+{
+    bool taken = hart.x[instruction.rs1] < hart.x[instruction.rs2];
+    if (taken) { hart.pc += (word_size) instruction.imm; }  // branch relative to the branch instruction
+    return !taken;                                          // pc should not count if branch is successful
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeBGEU(dec_instr_t instruction)
+{
+    bool taken = hart.x[instruction.rs1] >= hart.x[instruction.rs2];
+    if (taken) { hart.pc += (word_size) instruction.imm; }  // branch relative to the branch instruction
+    return !taken;                                          // pc should not count if branch is successful
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeJAL(dec_instr_t instruction)
+{
+    word_size target = hart.pc + (word_size) instruction.imm;  // jump relative to the jump instruction
+    hart.pc += sizeof(word);                                   // count to next instruction
+    hart.x[instruction.rd] = hart.pc;                          // store address after jump instruction into rd
+    hart.pc = target;                                          // jump to new address
+    return false;                                              // pc should not count after instruction is executed
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeJALR(dec_instr_t instruction)
+{
+    // bit 0 of imm is cleared, and the target is read before rd is written, since they may be the same register
+    word_size target = hart.x[instruction.rs1] + ((word_size) instruction.imm & ~(word_size) 1);
+    hart.pc += sizeof(word);           // count to next instruction
+    hart.x[instruction.rd] = hart.pc;  // store address after jump instruction into rd
+    hart.pc = target;                  // jump to new address
+    return false;                      // pc should not count after instruction is executed
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeLUI(dec_instr_t instruction)
+{
+    // Store sign ext'd imm into rd (useful for RV64 and RV128)
+    hart.x[instruction.rd] = (word_size) instruction.imm;
+    return true;
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeAUIPC(dec_instr_t instruction)
+{
+    hart.x[instruction.rd] = hart.pc + (word_size) instruction.imm;  // add sign ext'd imm to pc's value
+    return true;
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeEnvironment(dec_instr_t instruction)
+{
+    if((instruction.imm & 1) == 0)  // ECALL
+    {
+        setInterruptFlag(EC);
+    }
+    else  // EBREAK
+    {
+        setInterruptFlag(EB);
+        return false;  // pc will count after interrupt handler handles debugger
     }
-    else { return false; }  // there are no extensions to execute from
+    return true;
 }
 
-template <typename word_size>
-void RISC_V<word_size>::handleInterrupts()
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::isRestrictedAccess(word_size address)
 {
-    byte interruptFlags = memory->getByte(1);  // interrupt flags is a byte stored in address 1
+    // guarded memory makes restricted loads and stores fault on the host, so they only need checking on a rerun
+    if (!check_memory_accesses) { return false; }
+
+    return isProgramAddress(hart.pc) && !isProgramAddress(address) &&
+           (address < global_data_address_range.start || address > global_data_address_range.end);
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::isProgramAddress(word_size address)
+{
+    return address >= program_address_range.start && address <= program_address_range.end;
+}
+
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::updateGuards()
+{
+    // the bootloader and interrupt handler use the stack and devices, which would fault on every access if they were guarded
+    guards_active = isProgramAddress(hart.pc);
+    memory->setGuardBypass(!guards_active);
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::executeFromExtensions(dec_instr_t instruction)
+{
+    // no other extension owns the instruction, so no other one is asked
+    return decoding_extension != NULL && decoding_extension->execute(instruction);
+}
+
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::handleInterrupts()
+{
+    if (hart.interrupt_flags == 0) { return; }  // nothing is pending after almost every instruction
+    byte interruptFlags = hart.interrupt_flags;
 
     if ((interruptFlags & SAZ) != 0)  // there was an attempt to store data in address 0 (reserved for NULL pointers)
     {
         printf("EXCEPTION: Attempted to write to NULL\n");
-        printf(sizeof(word_size) <= 4 ? "PC = %X\n" : "PC = %llX\n", pc->read());
+        printf(sizeof(word_size) <= 4 ? "PC = %X\n" : "PC = %llX\n", hart.pc);
         printf("Terminating program...\n");
         running = false;
     }
     else if ((interruptFlags & II) != 0)  // CPU encountered an illegal instruction
     {
-        printf("EXCEPTION: Illegal Instruction: %08X\n", ir->read());
-        printf(sizeof(word_size) <= 4 ? "PC = %X\n" : "PC = %llX\n", pc->read());
+        printf("EXCEPTION: Illegal Instruction: %08X\n", hart.ir);
+        printf(sizeof(word_size) <= 4 ? "PC = %X\n" : "PC = %llX\n", hart.pc);
         printf("Terminating program...\n");
         running = false;
     }
     else if ((interruptFlags & SF) != 0)  // user program is attempting to access restricted memory space
     {
         printf("EXCEPTION: Segmentation Fault\n");
-        printf(sizeof(word_size) <= 4 ? "PC = %X\n" : "PC = %llX\n", pc->read());
+        printf(sizeof(word_size) <= 4 ? "PC = %X\n" : "PC = %llX\n", hart.pc);
         printf("Terminating program...\n");
         running = false;
     }
     else if ((interruptFlags & MSP) != 0)  // user program is attempting to modify stack pointer
     {
         printf("EXCEPTION: Attempted to modify Stack Pointer\n");
-        printf(sizeof(word_size) <= 4 ? "PC = %X\n" : "PC = %llX\n", pc->read());
+        printf(sizeof(word_size) <= 4 ? "PC = %X\n" : "PC = %llX\n", hart.pc);
         printf("Terminating program...\n");
         running = false;
     }
@@ -939,29 +1198,29 @@ void RISC_V<word_size>::handleInterrupts()
     {
         clearInterruptFlag(EB);
         debugger();
-        if ((interruptFlags & TP) == 0) { pc->count(); }
+        if ((interruptFlags & TP) == 0) { hart.pc += sizeof(word); }
     }
     else if ((interruptFlags & EC) != 0)  // user program or interrupt handler program called ECALL
     {
         clearInterruptFlag(EC);
         static word_size return_address = 0;
         // a call to ECALL from the user program jumps the pc to the interrupt handler program
-        if (pc->read() >= program_address_range.start && pc->read() <= program_address_range.end)
+        if (hart.pc >= program_address_range.start && hart.pc <= program_address_range.end)
         {
-            return_address = pc->read();
+            return_address = hart.pc;
             // jump to interrupt handler program
-            pc->write(interrupt_handler_address_range.start);
+            hart.pc = interrupt_handler_address_range.start;
         }
         // a call to ECALL from the interrupt handler program jumps the pc back to the user program
-        else if (pc->read() >= interrupt_handler_address_range.start && pc->read() <= interrupt_handler_address_range.end)
+        else if (hart.pc >= interrupt_handler_address_range.start && hart.pc <= interrupt_handler_address_range.end)
         {
-            pc->write(return_address);
+            hart.pc = return_address;
         }
         // a call to ECALL from any other memory location is not allowed and will terminate the program
         else
         {
             printf("EXCEPTION: Illegal Use of ECALL\n");
-            printf(sizeof(word_size) <= 4 ? "PC = %X\n" : "PC = %llX\n", pc->read());
+            printf(sizeof(word_size) <= 4 ? "PC = %X\n" : "PC = %llX\n", hart.pc);
             printf("Terminating program...\n");
             running = false;
         }
@@ -970,27 +1229,30 @@ void RISC_V<word_size>::handleInterrupts()
     if ((interruptFlags & TP) != 0)
     {
         printf("Exit command called\n");
-        printf(sizeof(word_size) <= 4 ? "PC = %X\n" : "PC = %llX\n", pc->read());
+        printf(sizeof(word_size) <= 4 ? "PC = %X\n" : "PC = %llX\n", hart.pc);
         printf("Terminating program...\n");
         running = false;
     }
     else if ((interruptFlags & RP) != 0)
     {
         printf("Restart command called\n");
-        printf(sizeof(word_size) <= 4 ? "PC = %X\n" : "PC = %llX\n", pc->read());
+        printf(sizeof(word_size) <= 4 ? "PC = %X\n" : "PC = %llX\n", hart.pc);
         printf("Restarting program...\n");
         running = false;
         restarting = true;
     }
 }
 
-template <typename word_size>
-void RISC_V<word_size>::start()
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::start()
 {
     // initialize registers and memory
-    pc->write(0);
-    ir->write(0);
-    for(byte i = 0; i < num_registers; i++) { register_set[i].write(0); }
+    hart = HartState<word_size>();
+    for (int tier = INTERPRETER; tier < NUM_TIERS; tier++)
+    {
+        tier_instructions[tier] = 0;
+        tier_seconds[tier] = 0;
+    }
     memory->clear();
 
     if (!loadMemory())  // load programs and data into memory
@@ -999,45 +1261,240 @@ void RISC_V<word_size>::start()
         return;
     }
 
-    pc->write(bootloader_address_range.start);  // PC should start execution from the bootloader's address for initialization
-    running = true;
-    restarting = false;
-    dec_instr_t decoded_instruction;
-    while(running)  // continously fetch, decode, and execute until an exception or interrupt occurs
+    hart.pc = bootloader_address_range.start;  // PC should start execution from the bootloader's address for initialization
+    takeSnapshot();                            // restarts go back to this state instead of loading programs again
+
+    // guarded memory only lets loads and stores reach the user program's own address ranges without faulting
+    // (adjacent ranges are unguarded together so the page they share doesn't stay guarded)
+    memory->guardRange({0, (word_size) -1}, true);
+    if (program_address_range.end + 1 == global_data_address_range.start)
     {
-        fetch();
-        decoded_instruction = decode();
-        execute(decoded_instruction);
-        handleInterrupts();
+        memory->guardRange({program_address_range.start, global_data_address_range.end}, false);
     }
+    else
+    {
+        memory->guardRange(program_address_range, false);
+        memory->guardRange(global_data_address_range, false);
+    }
+
+    current_tier = INTERPRETER;
+    tier_start = std::chrono::steady_clock::now();
+
+    sigjmp_buf fault_recovery_point;
+    memory->setRecoveryPoint(&fault_recovery_point);
+    restarting = false;
+    do
+    {
+        if (restarting) { restoreSnapshot(); }
+        running = true;
+        restarting = false;
+
+        if (sigsetjmp(fault_recovery_point, 1) != 0)
+        {
+            // a guarded load or store faulted before its instruction changed any state, so rerun it with range checks (in
+            // host code, pc was set to the faulting instruction before its access, so the ones before it count as retired)
+            if (native_block != NULL)
+            {
+                tier_instructions[NATIVE] += (hart.pc - native_block->start) / sizeof(word);
+                native_block = NULL;
+            }
+            check_memory_accesses = true;
+            memory->setGuardBypass(true);
+            execute(decodeInstruction());
+            tier_instructions[current_tier]++;
+            updateGuards();
+            check_memory_accesses = false;
+            handleInterrupts();
+        }
 
-    if (restarting) { start(); }
+        while(running) { runBlocks(); }  // continously execute blocks of instructions until an exception or interrupt occurs
+    } while (restarting);
+    memory->setRecoveryPoint(NULL);
+
+    if (tiers.report) { reportTiers(); }
+    if (!statistics_filename.empty()) { dumpStatistics(); }
     
     return;
 }
 
-template <typename word_size>
-RISC_V_Components<word_size> RISC_V<word_size>::getComponents()
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::setStatisticsFile(std::string filename, bool count_page_accesses)
+{
+    statistics_filename = filename;
+    memory->setPageCounting(count_page_accesses);
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::setHugePages(bool huge)
+{
+    return memory->setHugePages(global_data_address_range, huge);
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::setTiers(TierSettings settings)
+{
+    // a threshold of 0 promotes code the first time it's reached, like 1 does
+    settings.predecode_threshold = (settings.predecode_threshold == 0) ? 1 : settings.predecode_threshold;
+    settings.native_threshold = (settings.native_threshold == 0) ? 1 : settings.native_threshold;
+    tiers = settings;
+    return setJIT(settings.native);
+}
+
+template <typename word_size, endian_t endian>
+bool RISC_V<word_size, endian>::setJIT(bool enabled)
+{
+    delete jit;
+    jit = NULL;
+    tiers.native = false;
+    decode_cache->clear();  // blocks translated by the old JIT go with it
+    if (!enabled) { return true; }
+    if (!JIT<word_size, endian>::isSupported() || !tiers.predecoded) { return false; }
+
+    NativeContext<word_size> context = {&hart, this, {}, {}, program_address_range};
+    context.loads[0b000] = loadFromNativeCode<byte, s_byte>;            // LB
+    context.loads[0b001] = loadFromNativeCode<half_word, s_half_word>;  // LH
+    context.loads[0b010] = loadFromNativeCode<word, s_word>;            // LW
+    context.loads[0b100] = loadFromNativeCode<byte, byte>;              // LBU
+    context.loads[0b101] = loadFromNativeCode<half_word, half_word>;    // LHU
+    context.stores[0b000] = storeFromNativeCode<byte>;                  // SB
+    context.stores[0b001] = storeFromNativeCode<half_word>;             // SH
+    context.stores[0b010] = storeFromNativeCode<word>;                  // SW
+    if (sizeof(word_size) > 4)
+    {
+        context.loads[0b011] = loadFromNativeCode<double_word, double_word>;  // LD
+        context.loads[0b110] = loadFromNativeCode<word, word>;                // LWU
+        context.stores[0b011] = storeFromNativeCode<double_word>;             // SD
+    }
+
+    jit = new JIT<word_size, endian>(context);
+    if (!jit->isAvailable())
+    {
+        delete jit;
+        jit = NULL;
+        return false;
+    }
+    tiers.native = true;
+    return true;
+}
+
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::setProgramFile(std::string filename) { program_filename = filename; }
+
+template <typename word_size, endian_t endian>
+double_word RISC_V<word_size, endian>::getInstructionCount()
+{
+    return tier_instructions[INTERPRETER] + tier_instructions[PREDECODED] + tier_instructions[NATIVE];
+}
+
+template <typename word_size, endian_t endian>
+word_size RISC_V<word_size, endian>::getRegister(byte index)
 {
-    RISC_V_Components<word_size> components;
-    components.pc = pc;
-    components.ir = ir;
-    components.alu = alu;
-    components.register_set = register_set;
-    components.constants = constants;
+    return hart.x[index];
+}
+
+template <typename word_size, endian_t endian>
+double_word RISC_V<word_size, endian>::checksumMemory(AddressRange<word_size> range)
+{
+    double_word checksum = 0;
+    memory->setGuardBypass(true);  // outside start() there's nothing to recover a guarded load
+    for (double_word offset = 0; offset <= (double_word) (range.end - range.start); offset += sizeof(word_size))
+    {
+        checksum = checksum * 31 + memory->template load<word_size>(range.start + offset);
+    }
+    memory->setGuardBypass(!guards_active);
+    return checksum;
+}
+
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::dumpStatistics()
+{
+    FILE *file = fopen(statistics_filename.c_str(), "w");
+    if (file == NULL)
+    {
+        perror("Error opening statistics file");
+        return;
+    }
+
+    // regions that share a page both count it
+    const char *region_names[] = {"Bootloader", "Main program", "Global data", "Stack", "Interrupt handler"};
+    AddressRange<word_size> regions[] = {bootloader_address_range, program_address_range, global_data_address_range,
+                                         stack_address_range, interrupt_handler_address_range};
+    fprintf(file, "%s resident memory by region\n", base.c_str());
+    for (byte i = 0; i < 5; i++)
+    {
+        double_word pages = memory->getResidentPages(regions[i]);
+        fprintf(file, "%-18s %llu pages (%llu bytes)\n", region_names[i], pages, pages * Memory<word_size, endian>::PAGE_SIZE);
+    }
+    fprintf(file, "\n");
+    memory->dumpStatistics(file);
+    fclose(file);
+}
+
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::takeSnapshot()
+{
+    snapshot_hart = hart;
+    memory->takeSnapshot();
+}
+
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::restoreSnapshot()
+{
+    hart = snapshot_hart;
+    memory->resetToBaseline();
+}
+
+template <typename word_size, endian_t endian>
+RISC_V_Components<word_size, endian> RISC_V<word_size, endian>::getComponents()
+{
+    RISC_V_Components<word_size, endian> components;
+    components.hart = &hart;
     components.memory = memory;
 
     return components;
 }
 
-template <typename word_size>
-void RISC_V<word_size>::setInterruptFlag(interrupt_flag flag)
+template <typename word_size, endian_t endian>
+word RISC_V<word_size, endian>::encodingIndex(byte opcode, byte funct3, byte funct7)
+{
+    return ((opcode >> 2) << 10) | (funct3 << 7) | funct7;  // the low two bits of 32-bit opcodes are always 11
+}
+
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::claimEncodings(byte owner, const std::vector<ExtensionEncoding> &encodings)
+{
+    for (const ExtensionEncoding &encoding : encodings)
+    {
+        for (word funct3 = 0; funct3 < 8; funct3++)
+        {
+            if (encoding.funct3 != ANY && encoding.funct3 != (int) funct3) { continue; }
+            for (word funct7 = 0; funct7 < 128; funct7++)
+            {
+                if (encoding.funct7 != ANY && encoding.funct7 != (int) funct7) { continue; }
+                // an encoding two extensions claim stays with the one registered first
+                byte &entry = extension_owners[encodingIndex(encoding.opcode, funct3, funct7)];
+                if (entry == 0) { entry = owner; }
+            }
+        }
+    }
+}
+
+template <typename word_size, endian_t endian>
+byte RISC_V<word_size, endian>::findOwner(word raw_instruction)
+{
+    byte opcode = raw_instruction & 127;
+    if ((opcode & 0b11) != 0b11) { return 0; }  // only 32-bit instructions can be claimed
+    return extension_owners[encodingIndex(opcode, (raw_instruction >> 12) & 7, (raw_instruction >> 25) & 127)];
+}
+
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::setInterruptFlag(interrupt_flag flag)
 {
-    memory->setByte(1, memory->getByte(1) | flag);
+    hart.interrupt_flags |= flag;
 }
 
-template <typename word_size>
-void RISC_V<word_size>::clearInterruptFlag(interrupt_flag flag)
+template <typename word_size, endian_t endian>
+void RISC_V<word_size, endian>::clearInterruptFlag(interrupt_flag flag)
 {
-    memory->setByte(1, memory->getByte(1) & ~flag);
+    hart.interrupt_flags &= ~flag;
 }
\ No newline at end of file
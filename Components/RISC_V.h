@@ -3,60 +3,184 @@
 
 #include <vector>
 #include <string>
-#include <map>
+#include <type_traits>
+#include <chrono>
 #include "../Utilities/DataTypes.h"
 #include "../Utilities/DecodeAndEncodeInstructionFromFormat.h"
 #include "../Utilities/CombineFunct.h"
-#include "Register.h"
-#include "Counter.h"
-#include "ALU.h"
+#include "HartState.h"
 #include "Memory.h"
+#include "SystemDevice.h"
+#include "DecodeCache.h"
+#include "JIT.h"
 #include "../Extensions/Extension.h"
 
-template <typename word_size = word>
-using ConstantList = std::map<word_size, Register<word_size>>;
+template <typename word_size = word, endian_t endian = LITTLE>
+using ExtensionList = std::vector<Extension<word_size, endian>*>;
 
-template <typename word_size = word>
-using ExtensionList = std::vector<Extension<word_size>*>;
+typedef enum  // ways of running code, from the cheapest to start with to the fastest once started
+{
+    INTERPRETER,  // each instruction is fetched and decoded as it runs
+    PREDECODED,   // chained blocks of instructions that were decoded ahead
+    NATIVE,       // blocks translated into host code
+    NUM_TIERS
+} execution_tier_t;
+
+struct TierSettings  // when code is promoted to the next tier
+{
+    bool predecoded;  // blocks are formed once their start has been reached predecode_threshold times
+    bool native;  // predecoded blocks are translated once they have run native_threshold times (needs predecoded)
+    word predecode_threshold;
+    word native_threshold;
+    bool report;  // instructions run and time spent in each tier are printed on exit
+};
+
+const TierSettings DEFAULT_TIERS = {true, false, 2, 16, false};  // code reached twice is predecoded, and translating it is up to the user
 
-template <typename word_size = word>
+template <typename word_size = word, endian_t endian = LITTLE>
 class RISC_V
 {
     public:
-        RISC_V(byte number_of_registers = 32, endian_t endian = LITTLE);
-        RISC_V(byte number_of_registers, endian_t endian, ExtensionList<word_size> &extension_list);
-        RISC_V(ExtensionList<word_size> &extension_list);
+        typedef word_size word_type;  // what cores composed over a base ISA build on
+        static constexpr endian_t byte_order = endian;
+
+        RISC_V(byte number_of_registers = 32, memory_backend_t memory_backend = PAGED);
+        RISC_V(byte number_of_registers, ExtensionList<word_size, endian> &extension_list, memory_backend_t memory_backend = PAGED);
+        RISC_V(ExtensionList<word_size, endian> &extension_list);
         virtual ~RISC_V() = 0;  // pure virtual destructor ensures class is abstract and can't be instantiated
         virtual void start();
+        void setStatisticsFile(std::string filename, bool count_page_accesses = false);  // memory statistics are written there on exit
+        bool setHugePages(bool huge);  // backs global data with 2 MiB host pages (false if the memory backend or host can't)
+        bool setTiers(TierSettings settings);  // false if the native tier was asked for but isn't available
+        bool setJIT(bool enabled);  // turns the native tier on or off (false if the host can't run it, or blocks aren't predecoded)
+        void setProgramFile(std::string filename);  // main program binary (its global data is read from filename + "_data")
+        double_word getInstructionCount();  // instructions run in all tiers since start() was last called
+        word_size getRegister(byte index);  // value the program left in x[index] once start() returns
+        double_word checksumMemory(AddressRange<word_size> range);  // of the words in range, to tell whether two runs agree
     
     protected:
-        Counter<word_size> *pc;  // program counter
-        Register<word> *ir;  // instruction register
-        ALU<word_size> *alu;  // arithmetic logic unit
-        Register<word_size> *register_set;
-        ConstantList<word_size> *constants;
-        Memory<word_size> *memory;
-        ExtensionList<word_size> *extensions;  // list of ISA extensions
+        typedef typename std::make_signed<word_size>::type s_word_size;  // for signed comparisons and shifts
+
+        HartState<word_size> hart;  // registers, pc, ir, and interrupt flags
+        Memory<word_size, endian> *memory;
+        SystemDevice<word_size> *system_device;  // interrupt flags and NULL pointer detection at addresses 0 and 1
+        ExtensionList<word_size, endian> *extensions;  // list of ISA extensions
+        DecodeCache<word_size, endian> *decode_cache;  // instructions already decoded, by address
+        Extension<word_size, endian> *decoding_extension;  // extension that decoded the current instruction (NULL for the base ISA)
+        JIT<word_size, endian> *jit;  // NULL unless hot blocks are translated into host code
+        BasicBlock<word_size, endian> *native_block;  // block whose host code is running (NULL otherwise)
+        TierSettings tiers;
 
         std::string base;
         byte num_registers;
         bool running;
         bool restarting;
+        bool check_memory_accesses;  // false while guarded memory catches restricted loads and stores instead
+        bool guards_active;  // guarded memory only faults while the user program runs (the bootloader and handler bypass it)
+        // instructions run and time spent in each tier since start() (time is only measured if it's reported)
+        double_word tier_instructions[NUM_TIERS];
+        double tier_seconds[NUM_TIERS];
+        execution_tier_t current_tier;
+        std::chrono::steady_clock::time_point tier_start;  // when current_tier was entered
+
+        HartState<word_size> snapshot_hart;  // captured once programs are loaded, which restarts go back to
 
         AddressRange<word_size> bootloader_address_range;
         AddressRange<word_size> program_address_range;
         AddressRange<word_size> global_data_address_range;
         AddressRange<word_size> interrupt_handler_address_range;
+        AddressRange<word_size> stack_address_range;
+
+        std::string statistics_filename;  // empty if no statistics are written
+        std::string program_filename;
         
         virtual bool loadMemory();
+        bool loadSegment(int file, AddressRange<word_size> range, bool instructions);  // returns false if file doesn't fit in range
         virtual void debugger();  // a special debugger routine that runs when EBREAK is called
 
-        virtual void fetch();
+        void fetch();
         virtual dec_instr_t decode();  // returns valid instruction for a successful decoding
-        virtual bool execute(dec_instr_t instruction);  // returns true for a successful execution
-        virtual void handleInterrupts();  // handles any traps that are raised
+        dec_instr_t decodeInstruction();  // decode(), with writes to x0 sent to the sink instead
+        dec_instr_t fetchAndDecode();  // decodes each instruction once, and again only after its page is written
+        PackedInstruction<word_size, endian>* getPredecoded(word_size address);  // returns NULL if the instruction can't be cached
+        BasicBlock<word_size, endian>* getBlock(word_size address);  // forms the block first if needed (NULL if it can't be cached)
+        void runBlocks();  // runs chained blocks from pc until an interrupt is pending or code is written
+        void interpretBlock();  // runs instructions from pc without predecoding them, up to where their block would end
+        static bool endsBlock(bool valid, byte opcode);  // true for instructions that may not continue with the next one
+        void enterTier(execution_tier_t tier);  // adds the time since the last switch to the tier that was running
+        void reportTiers();
+        bool execute(dec_instr_t instruction);  // returns true for a successful execution (runs getHandler()'s handler)
+        void handleInterrupts();  // handles any traps that are raised
+
+        virtual dec_instr_t decodeFromExtensions();  // calls decode() from the extension that owns the instruction, if any
+        virtual std::string describeExtensions();  // names of the extensions for the debugger (or "None")
+        bool executeFromExtensions(dec_instr_t instruction);  // calls execute() from the extension that decoded the instruction
+        bool isRestrictedAccess(word_size address);  // returns true if the user program may not load or store at address
+        bool isProgramAddress(word_size address);
+        void updateGuards();  // turns guards on if pc is in the user program, and bypasses them otherwise
+        void takeSnapshot();  // captures registers and memory
+        void restoreSnapshot();  // restores registers and memory without reloading any programs
+        void dumpStatistics();
+        RISC_V_Components<word_size, endian> getComponents();
+
+        // Extensions claim the encodings they decode as they're registered, so an instruction the base ISA doesn't have
+        // goes straight to the extension that owns it (or is illegal if none does), however many extensions there are.
+        std::vector<byte> extension_owners;  // position of the owning extension plus one (0 for none), by encodingIndex()
+        static word encodingIndex(byte opcode, byte funct3, byte funct7);
+        void claimEncodings(byte owner, const std::vector<ExtensionEncoding> &encodings);  // encodings already owned are kept
+        byte findOwner(word raw_instruction);  // 0 if no extension owns the instruction
 
-        bool executeFromExtensions(dec_instr_t instruction);  // calls execute() from extensions
+        // Instructions are run by handlers from a table, by opcode, funct3, and funct7, that the base ISA's constructors fill
+        // in. A handler returns false if pc mustn't count to the next instruction (because it jumped or raised an exception).
+        typedef bool (RISC_V::*Handler)(dec_instr_t instruction);
+        static constexpr int ANY = -1;  // funct3 or funct7 of instructions that don't depend on it
+        std::vector<Handler> handlers;  // by handlerIndex()
+        Handler extension_handler;  // runs whatever the base ISA doesn't have
+        static byte funct7Class(byte funct7);
+        static word handlerIndex(byte opcode, byte funct3, byte funct7_class);
+        void setHandler(byte opcode, int funct3, int funct7, Handler handler);
+        Handler getHandler(const dec_instr_t &instruction, word_size address);  // handler of the instruction at address
+        void setBaseHandlers();
+        bool executeByExtension(dec_instr_t instruction);
+        bool executeInvalid(dec_instr_t instruction);
+        bool executeStackPointerWrite(dec_instr_t instruction);
+        bool executeADD(dec_instr_t instruction);
+        bool executeSUB(dec_instr_t instruction);
+        bool executeSLL(dec_instr_t instruction);
+        bool executeSLT(dec_instr_t instruction);
+        bool executeSLTU(dec_instr_t instruction);
+        bool executeXOR(dec_instr_t instruction);
+        bool executeSRL(dec_instr_t instruction);
+        bool executeSRA(dec_instr_t instruction);
+        bool executeOR(dec_instr_t instruction);
+        bool executeAND(dec_instr_t instruction);
+        bool executeADDI(dec_instr_t instruction);
+        bool executeSLLI(dec_instr_t instruction);
+        bool executeSLTI(dec_instr_t instruction);
+        bool executeSLTIU(dec_instr_t instruction);
+        bool executeXORI(dec_instr_t instruction);
+        bool executeShiftRightImmediate(dec_instr_t instruction);
+        bool executeORI(dec_instr_t instruction);
+        bool executeANDI(dec_instr_t instruction);
+        bool executeLB(dec_instr_t instruction);
+        bool executeLH(dec_instr_t instruction);
+        bool executeLW(dec_instr_t instruction);
+        bool executeLBU(dec_instr_t instruction);
+        bool executeLHU(dec_instr_t instruction);
+        bool executeSB(dec_instr_t instruction);
+        bool executeSH(dec_instr_t instruction);
+        bool executeSW(dec_instr_t instruction);
+        bool executeBEQ(dec_instr_t instruction);
+        bool executeBNE(dec_instr_t instruction);
+        bool executeBLT(dec_instr_t instruction);
+        bool executeBGE(dec_instr_t instruction);
+        bool executeBLTU(dec_instr_t instruction);
+        bool executeBGEU(dec_instr_t instruction);
+        bool executeJAL(dec_instr_t instruction);
+        bool executeJALR(dec_instr_t instruction);
+        bool executeLUI(dec_instr_t instruction);
+        bool executeAUIPC(dec_instr_t instruction);
+        bool executeEnvironment(dec_instr_t instruction);
 
         enum menu_options
         {
@@ -79,11 +203,15 @@ class RISC_V
             RP  = 0b10000000
         };
 
-        virtual void setInterruptFlag(interrupt_flag flag);
-        virtual void clearInterruptFlag(interrupt_flag flag);
+        void setInterruptFlag(interrupt_flag flag);
+        void clearInterruptFlag(interrupt_flag flag);
 
     private:
-        RISC_V_Components<word_size> getComponents();
+        // loads and stores of translated code, which leave pc and the instruction register as the interpreter would
+        template <typename data_size, typename extended_size>
+            static bool loadFromNativeCode(void *cpu, word_size instruction_address, word raw_instruction, word_size address, word_size rd);
+        template <typename data_size>
+            static bool storeFromNativeCode(void *cpu, word_size instruction_address, word raw_instruction, word_size address, word_size value);
 };
 
 #endif
\ No newline at end of file
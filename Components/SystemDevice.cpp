@@ -0,0 +1,27 @@
+#include "SystemDevice.h"
+
+template <typename address_size>
+SystemDevice<address_size>::SystemDevice(byte *interrupt_flags) : interrupt_flags(interrupt_flags) {}
+
+template <typename address_size>
+address_size SystemDevice<address_size>::read(address_size address, byte *data, address_size size)
+{
+    address_size count = 0;
+    for(; count < size && address + count <= ADDRESS_RANGE.end; count++)
+    {
+        data[count] = (address + count == 1) ? *interrupt_flags : 0;  // nothing is ever stored at address 0
+    }
+    return count;
+}
+
+template <typename address_size>
+address_size SystemDevice<address_size>::write(address_size address, const byte *data, address_size size)
+{
+    if(address == 0)  // attempting to store to address 0 will set the SAZ flag in the interrupt flags, and nothing is stored
+    {
+        *interrupt_flags |= 1;
+        return size;
+    }
+    *interrupt_flags = data[0];
+    return 1;
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef SYSTEM_DEVICE_H
+#define SYSTEM_DEVICE_H
+
+#include "../Utilities/DataTypes.h"
+#include "Device.h"
+
+// Addresses 0 and 1: storing to address 0 (NULL) sets the SAZ flag instead, and address 1 holds the interrupt flags
+template <typename address_size = word>
+class SystemDevice : public Device<address_size>
+{
+    public:
+        SystemDevice(byte *interrupt_flags);
+        address_size read(address_size address, byte *data, address_size size) override;
+        address_size write(address_size address, const byte *data, address_size size) override;
+
+        static constexpr AddressRange<address_size> ADDRESS_RANGE = {0, 1};
+
+    private:
+        byte *interrupt_flags;
+};
+
+#endif
\ No newline at end of file
@@ -2,47 +2,50 @@
 #define EXTENSION_H
 
 #include <string>
-#include <map>
+#include <vector>
 #include "../Utilities/DataTypes.h"
 #include "../Utilities/DecodeAndEncodeInstructionFromFormat.h"
 #include "../Utilities/CombineFunct.h"
-#include "../Components/Register.h"
-#include "../Components/Counter.h"
-#include "../Components/ALU.h"
+#include "../Components/HartState.h"
 #include "../Components/Memory.h"
 
-template <typename word_size = word>
+template <typename word_size = word, endian_t endian = LITTLE>
 struct RISC_V_Components
 {
-    Counter<word_size> *pc;
-    Register<word> *ir;
-    ALU<word_size> *alu;
-    Register<word_size> *register_set;
-    std::map<word_size, Register<word_size>> *constants;
-    Memory<word_size> *memory;
+    HartState<word_size> *hart;
+    Memory<word_size, endian> *memory;
 };
 
-template <typename word_size = word>
+struct ExtensionEncoding  // instructions an extension decodes: a 32-bit opcode, with its funct3 and funct7 (or ANY value)
+{
+    byte opcode;
+    int funct3;
+    int funct7;
+};
+
+template <typename word_size = word, endian_t endian = LITTLE>
 class Extension
 {
     public:
         Extension();
-        Extension(RISC_V_Components<word_size> &cpu_components);
+        Extension(RISC_V_Components<word_size, endian> &cpu_components);
         virtual ~Extension();
         // allows derived classes to create new objects and assign it the cpu's components
-        virtual Extension<word_size>* create(RISC_V_Components<word_size> &cpu_components) = 0;
+        virtual Extension<word_size, endian>* create(RISC_V_Components<word_size, endian> &cpu_components) = 0;
         virtual dec_instr_t decode() = 0;  // returns valid instruction for a successful decoding
         virtual bool execute(dec_instr_t instruction) = 0;  // returns true for a successful execution
         virtual std::string getName();
+        virtual std::vector<ExtensionEncoding> getEncodings();  // the CPU only asks the extension to decode these
+        bool isStandardM();  // true if its instructions behave as the M extension's, which the JIT translates itself
+
+        static constexpr int ANY = -1;  // funct3 or funct7 of encodings that don't depend on it
     
     protected:
         std::string name;
-        Counter<word_size> *cpu_pc;  // CPU's program counter
-        Register<word> *cpu_ir;  // CPU's instruction register
-        ALU<word_size> *cpu_alu;  // CPU's arithmetic logic unit
-        Register<word_size> *cpu_register_set;
-        std::map<word_size, Register<word_size>> *cpu_constants;
-        Memory<word_size> *cpu_memory;
+        std::vector<ExtensionEncoding> encodings;
+        bool standard_M;
+        HartState<word_size> *cpu_hart;  // CPU's registers, program counter, and instruction register
+        Memory<word_size, endian> *cpu_memory;
 };
 
 #endif
\ No newline at end of file
@@ -1,27 +1,35 @@
 #include "M.h"
 #include "../Utilities/CombineFunct.h"
 
-template <typename word_size>
-M<word_size>::M() : Extension<word_size>() { name = "M"; }
+template <typename word_size, endian_t endian>
+M<word_size, endian>::M() : Extension<word_size, endian>() { name = "M"; standard_M = true; setEncodings(); }
 
-template <typename word_size>
-M<word_size>::M(RISC_V_Components<word_size> &cpu_components) : Extension<word_size>(cpu_components)
-    { name = "M"; cpu_alu = new Multiplier<word_size>(); }
+template <typename word_size, endian_t endian>
+M<word_size, endian>::M(RISC_V_Components<word_size, endian> &cpu_components) : Extension<word_size, endian>(cpu_components)
+    { name = "M"; standard_M = true; setEncodings(); }
 
-template <typename word_size>
-M<word_size>::~M() { if (cpu_alu != NULL) { delete cpu_alu; } }
+template <typename word_size, endian_t endian>
+M<word_size, endian>::~M() {}
 
-template <typename word_size>
-M<word_size>* M<word_size>::create(RISC_V_Components<word_size> &cpu_components)
+template <typename word_size, endian_t endian>
+M<word_size, endian>* M<word_size, endian>::create(RISC_V_Components<word_size, endian> &cpu_components)
 {
-    M<word_size> *copy = new M<word_size>(cpu_components);
+    M<word_size, endian> *copy = new M<word_size, endian>(cpu_components);
     return copy;
 }
 
-template <typename word_size>
-dec_instr_t M<word_size>::decode()
+template <typename word_size, endian_t endian>
+void M<word_size, endian>::setEncodings()
+{
+    encodings = {{ARITH_LOG_R, ANY, 0b0000001}};  // All M instructions have funct7 = 1
+    // RV32M should not be able to decode ARITH_LOG_R_W instructions
+    if (sizeof(word_size) > 4) { encodings.push_back({ARITH_LOG_R_W, ANY, 0b0000001}); }
+}
+
+template <typename word_size, endian_t endian>
+dec_instr_t M<word_size, endian>::decode()
 { 
-    word raw_instruction = cpu_ir->read();
+    word raw_instruction = cpu_hart->ir;
     byte opcode = raw_instruction & 127;  // retrieve opcode from least significant 7 bits
     dec_instr_t decoded_instruction;  // decoded instruction should be invalid by default
 
@@ -43,8 +51,8 @@ dec_instr_t M<word_size>::decode()
     return decoded_instruction;
 }
 
-template <typename word_size>
-bool M<word_size>::execute(dec_instr_t instruction)
+template <typename word_size, endian_t endian>
+bool M<word_size, endian>::execute(dec_instr_t instruction)
 { 
     // Invalid instructions are obviously not allowed to continue 
     if(!instruction.valid) { return false; }
@@ -58,51 +66,51 @@ bool M<word_size>::execute(dec_instr_t instruction)
             switch (combineFunct(instruction.funct3, instruction.funct7))
             {
                 case 0b0000000001:  // MUL
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rs1].read());   // load rs1's value into ALU
-                    cpu_alu->operate(MUL, cpu_register_set[instruction.rs2].read());  // perform MUL with rs2's value
-                    cpu_register_set[instruction.rd].write(cpu_alu->getResult());     // store result into rd
+                    multiplier.setOperand1(cpu_hart->x[instruction.rs1]);   // load rs1's value into ALU
+                    multiplier.operate(MUL, cpu_hart->x[instruction.rs2]);  // perform MUL with rs2's value
+                    cpu_hart->x[instruction.rd] = multiplier.getResult();   // store result into rd
                     break;
                 
                 case 0b0010000001:  // MULH
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rs1].read());    // load rs1's value into ALU
-                    cpu_alu->operate(MULH, cpu_register_set[instruction.rs2].read());  // perform MULH with rs2's value
-                    cpu_register_set[instruction.rd].write(cpu_alu->getResult());      // store result into rd
+                    multiplier.setOperand1(cpu_hart->x[instruction.rs1]);    // load rs1's value into ALU
+                    multiplier.operate(MULH, cpu_hart->x[instruction.rs2]);  // perform MULH with rs2's value
+                    cpu_hart->x[instruction.rd] = multiplier.getResult();    // store result into rd
                     break;
                 
                 case 0b0100000001:  // MULHSU
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rs1].read());      // load rs1's value into ALU
-                    cpu_alu->operate(MULHSU, cpu_register_set[instruction.rs2].read());  // perform MULHSU with rs2's value
-                    cpu_register_set[instruction.rd].write(cpu_alu->getResult());        // store result into rd
+                    multiplier.setOperand1(cpu_hart->x[instruction.rs1]);      // load rs1's value into ALU
+                    multiplier.operate(MULHSU, cpu_hart->x[instruction.rs2]);  // perform MULHSU with rs2's value
+                    cpu_hart->x[instruction.rd] = multiplier.getResult();      // store result into rd
                     break;
 
                 case 0b0110000001:  // MULHU
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rs1].read());     // load rs1's value into ALU
-                    cpu_alu->operate(MULHU, cpu_register_set[instruction.rs2].read());  // perform MULHU with rs2's value
-                    cpu_register_set[instruction.rd].write(cpu_alu->getResult());       // store result into rd
+                    multiplier.setOperand1(cpu_hart->x[instruction.rs1]);     // load rs1's value into ALU
+                    multiplier.operate(MULHU, cpu_hart->x[instruction.rs2]);  // perform MULHU with rs2's value
+                    cpu_hart->x[instruction.rd] = multiplier.getResult();     // store result into rd
                     break;
 
                 case 0b1000000001:  // DIV
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rs1].read());   // load rs1's value into ALU
-                    cpu_alu->operate(DIV, cpu_register_set[instruction.rs2].read());  // perform DIV with rs2's value
-                    cpu_register_set[instruction.rd].write(cpu_alu->getResult());     // store result into rd
+                    multiplier.setOperand1(cpu_hart->x[instruction.rs1]);   // load rs1's value into ALU
+                    multiplier.operate(DIV, cpu_hart->x[instruction.rs2]);  // perform DIV with rs2's value
+                    cpu_hart->x[instruction.rd] = multiplier.getResult();   // store result into rd
                     break;
 
                 case 0b1010000001:  // DIVU
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rs1].read());    // load rs1's value into ALU
-                    cpu_alu->operate(DIVU, cpu_register_set[instruction.rs2].read());  // perform DIVU with rs2's value
-                    cpu_register_set[instruction.rd].write(cpu_alu->getResult());      // store result into rd
+                    multiplier.setOperand1(cpu_hart->x[instruction.rs1]);    // load rs1's value into ALU
+                    multiplier.operate(DIVU, cpu_hart->x[instruction.rs2]);  // perform DIVU with rs2's value
+                    cpu_hart->x[instruction.rd] = multiplier.getResult();    // store result into rd
                     break;
 
                 case 0b1100000001:  // REM
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rs1].read());   // load rs1's value into ALU
-                    cpu_alu->operate(REM, cpu_register_set[instruction.rs2].read());  // perform REM with rs2's value
-                    cpu_register_set[instruction.rd].write(cpu_alu->getResult());     // store result into rd
+                    multiplier.setOperand1(cpu_hart->x[instruction.rs1]);   // load rs1's value into ALU
+                    multiplier.operate(REM, cpu_hart->x[instruction.rs2]);  // perform REM with rs2's value
+                    cpu_hart->x[instruction.rd] = multiplier.getResult();   // store result into rd
                     break;
 
                 case 0b1110000001:  // REMU
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rs1].read());    // load rs1's value into ALU
-                    cpu_alu->operate(REMU, cpu_register_set[instruction.rs2].read());  // perform REMU with rs2's value
-                    cpu_register_set[instruction.rd].write(cpu_alu->getResult());      // store result into rd
+                    multiplier.setOperand1(cpu_hart->x[instruction.rs1]);    // load rs1's value into ALU
+                    multiplier.operate(REMU, cpu_hart->x[instruction.rs2]);  // perform REMU with rs2's value
+                    cpu_hart->x[instruction.rd] = multiplier.getResult();    // store result into rd
                     break;
 
                 default:
@@ -115,55 +123,55 @@ bool M<word_size>::execute(dec_instr_t instruction)
             switch (combineFunct(instruction.funct3, instruction.funct7))
             {
                 case 0b0000000001:  // MULW
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rs1].read());   // load rs1's value into ALU
-                    cpu_alu->operate(MUL, cpu_register_set[instruction.rs2].read());  // perform MUL with rs2's value
-                    cpu_alu->setOperand1(cpu_alu->getResult());                       // load result into ALU
-                    cpu_alu->operate(SXT, (*cpu_constants).at(0x80000000).read());    // sign extend result by bit 31
-                    cpu_register_set[instruction.rd].write(cpu_alu->getResult());     // store sign ext'd result into rd
+                    multiplier.setOperand1(cpu_hart->x[instruction.rs1]);   // load rs1's value into ALU
+                    multiplier.operate(MUL, cpu_hart->x[instruction.rs2]);  // perform MUL with rs2's value
+                    multiplier.setOperand1(multiplier.getResult());         // load result into ALU
+                    multiplier.operate(SXT, 0x80000000);                    // sign extend result by bit 31
+                    cpu_hart->x[instruction.rd] = multiplier.getResult();   // store sign ext'd result into rd
                     break;
 
                 case 0b1000000001:  // DIVW
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rs1].read());   // load rs1's value into ALU
-                    cpu_alu->operate(SXT, (*cpu_constants).at(0x80000000).read());    // sign extend rs1's value by bit 31
-                    cpu_register_set[instruction.rd].write(cpu_alu->getResult());     // temporarily store sign ext'd rs1 into rd
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rs2].read());   // load rs2's value into ALU
-                    cpu_alu->operate(SXT, (*cpu_constants).at(0x80000000).read());    // sign extend rs2's value by bit 31
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rd].read());    // load sign ext'd rd1 into ALU
-                    cpu_alu->operate(DIV, cpu_alu->getResult());                      // perform DIV with sign ext'd rs2
-                    cpu_register_set[instruction.rd].write(cpu_alu->getResult());     // store result into rd
+                    multiplier.setOperand1(cpu_hart->x[instruction.rs1]);  // load rs1's value into ALU
+                    multiplier.operate(SXT, 0x80000000);                   // sign extend rs1's value by bit 31
+                    cpu_hart->x[instruction.rd] = multiplier.getResult();  // temporarily store sign ext'd rs1 into rd
+                    multiplier.setOperand1(cpu_hart->x[instruction.rs2]);  // load rs2's value into ALU
+                    multiplier.operate(SXT, 0x80000000);                   // sign extend rs2's value by bit 31
+                    multiplier.setOperand1(cpu_hart->x[instruction.rd]);   // load sign ext'd rd1 into ALU
+                    multiplier.operate(DIV, multiplier.getResult());       // perform DIV with sign ext'd rs2
+                    cpu_hart->x[instruction.rd] = multiplier.getResult();  // store result into rd
                     break;
 
                 case 0b1010000001:  // DIVUW
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rs1].read());   // load rs1's value into ALU
-                    cpu_alu->operate(AND, (*cpu_constants).at(0xFFFFFFFF).read());    // zero extend rs1's value by bit 31
-                    cpu_register_set[instruction.rd].write(cpu_alu->getResult());     // temporarily store zero ext'd rs1 into rd
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rs2].read());   // load rs2's value into ALU
-                    cpu_alu->operate(AND, (*cpu_constants).at(0xFFFFFFFF).read());    // zero extend rs2's value by bit 31
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rd].read());    // load zero ext'd rd1 into ALU
-                    cpu_alu->operate(DIVU, cpu_alu->getResult());                     // perform DIVU with zero ext'd rs2
-                    cpu_register_set[instruction.rd].write(cpu_alu->getResult());     // store result into rd
+                    multiplier.setOperand1(cpu_hart->x[instruction.rs1]);  // load rs1's value into ALU
+                    multiplier.operate(AND, 0xFFFFFFFF);                   // zero extend rs1's value by bit 31
+                    cpu_hart->x[instruction.rd] = multiplier.getResult();  // temporarily store zero ext'd rs1 into rd
+                    multiplier.setOperand1(cpu_hart->x[instruction.rs2]);  // load rs2's value into ALU
+                    multiplier.operate(AND, 0xFFFFFFFF);                   // zero extend rs2's value by bit 31
+                    multiplier.setOperand1(cpu_hart->x[instruction.rd]);   // load zero ext'd rd1 into ALU
+                    multiplier.operate(DIVU, multiplier.getResult());      // perform DIVU with zero ext'd rs2
+                    cpu_hart->x[instruction.rd] = multiplier.getResult();  // store result into rd
                     break;
 
                 case 0b1100000001:  // REMW
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rs1].read());   // load rs1's value into ALU
-                    cpu_alu->operate(SXT, (*cpu_constants).at(0x80000000).read());    // sign extend rs1's value by bit 31
-                    cpu_register_set[instruction.rd].write(cpu_alu->getResult());     // temporarily store sign ext'd rs1 into rd
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rs2].read());   // load rs2's value into ALU
-                    cpu_alu->operate(SXT, (*cpu_constants).at(0x80000000).read());    // sign extend rs2's value by bit 31
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rd].read());    // load sign ext'd rd1 into ALU
-                    cpu_alu->operate(REM, cpu_alu->getResult());                      // perform REM with sign ext'd rs2
-                    cpu_register_set[instruction.rd].write(cpu_alu->getResult());     // store result into rd
+                    multiplier.setOperand1(cpu_hart->x[instruction.rs1]);  // load rs1's value into ALU
+                    multiplier.operate(SXT, 0x80000000);                   // sign extend rs1's value by bit 31
+                    cpu_hart->x[instruction.rd] = multiplier.getResult();  // temporarily store sign ext'd rs1 into rd
+                    multiplier.setOperand1(cpu_hart->x[instruction.rs2]);  // load rs2's value into ALU
+                    multiplier.operate(SXT, 0x80000000);                   // sign extend rs2's value by bit 31
+                    multiplier.setOperand1(cpu_hart->x[instruction.rd]);   // load sign ext'd rd1 into ALU
+                    multiplier.operate(REM, multiplier.getResult());       // perform REM with sign ext'd rs2
+                    cpu_hart->x[instruction.rd] = multiplier.getResult();  // store result into rd
                     break;
 
                 case 0b1110000001:  // REMUW
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rs1].read());   // load rs1's value into ALU
-                    cpu_alu->operate(AND, (*cpu_constants).at(0xFFFFFFFF).read());    // zero extend rs1's value by bit 31
-                    cpu_register_set[instruction.rd].write(cpu_alu->getResult());     // temporarily store zero ext'd rs1 into rd
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rs2].read());   // load rs2's value into ALU
-                    cpu_alu->operate(AND, (*cpu_constants).at(0xFFFFFFFF).read());    // zero extend rs2's value by bit 31
-                    cpu_alu->setOperand1(cpu_register_set[instruction.rd].read());    // load zero ext'd rd1 into ALU
-                    cpu_alu->operate(REMU, cpu_alu->getResult());                     // perform REMU with zero ext'd rs2
-                    cpu_register_set[instruction.rd].write(cpu_alu->getResult());     // store result into rd
+                    multiplier.setOperand1(cpu_hart->x[instruction.rs1]);  // load rs1's value into ALU
+                    multiplier.operate(AND, 0xFFFFFFFF);                   // zero extend rs1's value by bit 31
+                    cpu_hart->x[instruction.rd] = multiplier.getResult();  // temporarily store zero ext'd rs1 into rd
+                    multiplier.setOperand1(cpu_hart->x[instruction.rs2]);  // load rs2's value into ALU
+                    multiplier.operate(AND, 0xFFFFFFFF);                   // zero extend rs2's value by bit 31
+                    multiplier.setOperand1(cpu_hart->x[instruction.rd]);   // load zero ext'd rd1 into ALU
+                    multiplier.operate(REMU, multiplier.getResult());      // perform REMU with zero ext'd rs2
+                    cpu_hart->x[instruction.rd] = multiplier.getResult();  // store result into rd
                     break;
             }
             break;
@@ -4,24 +4,28 @@
 #include "../Components/Multiplier.h"
 #include "Extension.h"
 
-template <typename word_size = word>
-class M : public Extension<word_size>
+template <typename word_size = word, endian_t endian = LITTLE>
+class M : public Extension<word_size, endian>
 {
-    using Extension<word_size>::name;
-    using Extension<word_size>::cpu_pc;
-    using Extension<word_size>::cpu_ir;
-    using Extension<word_size>::cpu_alu;
-    using Extension<word_size>::cpu_register_set;
-    using Extension<word_size>::cpu_constants;
-    using Extension<word_size>::cpu_memory;
+    using Extension<word_size, endian>::name;
+    using Extension<word_size, endian>::encodings;
+    using Extension<word_size, endian>::standard_M;
+    using Extension<word_size, endian>::ANY;
+    using Extension<word_size, endian>::cpu_hart;
+    using Extension<word_size, endian>::cpu_memory;
     
     public:
         M();
-        M(RISC_V_Components<word_size> &cpu_components);
+        M(RISC_V_Components<word_size, endian> &cpu_components);
         ~M();
-        M<word_size>* create(RISC_V_Components<word_size> &cpu_components) override;
+        M<word_size, endian>* create(RISC_V_Components<word_size, endian> &cpu_components) override;
         dec_instr_t decode() override;
         bool execute(dec_instr_t instruction) override;
+
+    private:
+        Multiplier<word_size> multiplier;  // ALU that also multiplies and divides
+
+        void setEncodings();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+# Counts the primes below 8192 with a sieve of Eratosthenes, 300 times over, for benchmarkJIT() (runs without input)
+start:
+    li s0, 0x40010000  # sieve of one byte per number, in global data
+    li s1, 8192        # numbers in the sieve
+    li s2, 300         # rounds left
+    li s3, 0           # primes counted over all rounds
+    li s4, 0           # primes counted in the last round (a0 is cleared when the program terminates)
+round:
+    # mark every number as prime
+    mv t0, s0
+    add t1, s0, s1
+    li t2, 0x01010101
+1:  sw t2, 0(t0)
+    addi t0, t0, 4
+    bltu t0, t1, 1b
+    # cross out the multiples of each prime, from its square up
+    li t0, 2
+2:  mul t1, t0, t0
+    bgeu t1, s1, 5f
+    add t2, s0, t0
+    lbu t2, 0(t2)
+    beqz t2, 4f
+3:  add t2, s0, t1
+    sb zero, 0(t2)
+    add t1, t1, t0
+    bltu t1, s1, 3b
+4:  addi t0, t0, 1
+    j 2b
+    # count what's left
+5:  li t0, 2
+    li a0, 0
+6:  add t2, s0, t0
+    lbu t2, 0(t2)
+    add a0, a0, t2
+    addi t0, t0, 1
+    bltu t0, s1, 6b
+    add s3, s3, a0
+    mv s4, a0
+    addi s2, s2, -1
+    bnez s2, round
+    # terminate program
+    li a2, 0x1
+    ecall
\ No newline at end of file
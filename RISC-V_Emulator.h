@@ -1,8 +1,11 @@
 #include "Components/Register.cpp"
 #include "Components/ALU.cpp"
 #include "Components/Multiplier.cpp"
+#include "Components/Device.cpp"
+#include "Components/SystemDevice.cpp"
 #include "Components/Memory.cpp"
-#include "Components/Counter.cpp"
+#include "Components/DecodeCache.cpp"
+#include "Components/JIT.cpp"
 #include "Components/RISC_V.cpp"
 #include "Base_ISAs/RV32I.cpp"
 #include "Base_ISAs/RV64I.cpp"
@@ -10,5 +13,7 @@
 #include "Base_ISAs/RV64E.cpp"
 #include "Extensions/Extension.cpp"
 #include "Extensions/M.cpp"
+#include "Components/Core.cpp"
 #include "Utilities/HexDump.h"
+#include "Utilities/Benchmark.h"
 #include "Utilities/Assemble.h"
\ No newline at end of file
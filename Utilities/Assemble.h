@@ -10,6 +10,19 @@
 #include <unordered_map>
 #include "DataTypes.h"
 
+// strtoull with base 0, which also takes binary numbers with a 0b prefix (only newer C libraries parse those themselves)
+unsigned long long parseInteger(const char *text, char **end_ptr)
+{
+    const char *digits = text;
+    if (*digits == '-' || *digits == '+') { digits++; }
+    if (digits[0] == '0' && (digits[1] == 'b' || digits[1] == 'B') && (digits[2] == '0' || digits[2] == '1'))
+    {
+        unsigned long long value = strtoull(digits + 2, end_ptr, 2);
+        return (*text == '-') ? 0 - value : value;
+    }
+    return strtoull(text, end_ptr, 0);
+}
+
 // Assemble a specific file
 template <typename word_size = word>
 bool assemble(std::string asm_filename, endian_t endian = LITTLE, word_size data_rel_address = -1)
@@ -706,7 +719,7 @@ bool assemble(std::string asm_filename, endian_t endian = LITTLE, word_size data
                         printf("Values: ");
                         while (instruction.size() > 0)
                         {
-                            curr_num = strtoll(instruction[0].c_str(), &end_ptr, 0);
+                            curr_num = (long long) parseInteger(instruction[0].c_str(), &end_ptr);
                             
                             if (*end_ptr == '\'')  // char literal
                             {
@@ -1062,7 +1075,7 @@ bool assemble(std::string asm_filename, endian_t endian = LITTLE, word_size data
                     {
                         std::size_t open_par_pos = instruction[i+1].find('('), closed_par_pos = instruction[i+1].find(')');
                         // get immediate offset
-                        operands[i] = strtoull(instruction[i+1].substr(0, open_par_pos).c_str(), &end_ptr, 0);
+                        operands[i] = parseInteger(instruction[i+1].substr(0, open_par_pos).c_str(), &end_ptr);
 
                         if (*end_ptr != 0)
                         {
@@ -1110,7 +1123,7 @@ bool assemble(std::string asm_filename, endian_t endian = LITTLE, word_size data
                     else  // otherwise, operand is an immediate value or possible forward ref
                     {
                         // base is determined from prefix (0b = binary, 0 = octal, 0x = hex, no prefix = decimal)
-                        operands[i] = strtoull(instruction[i+1].c_str(), &end_ptr, 0);
+                        operands[i] = parseInteger(instruction[i+1].c_str(), &end_ptr);
 
                         if (*end_ptr != 0 && assembling && !forward_ref_found)
                         {
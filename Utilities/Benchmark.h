@@ -0,0 +1,244 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "DataTypes.h"
+#include "../Components/Memory.h"
+#include "../Base_ISAs/RV32I.h"
+#include "../Base_ISAs/RV64I.h"
+#include "../Extensions/M.h"
+#include "Assemble.h"
+
+// seconds elapsed since start
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// opens a disabled counter of this thread's data TLB load misses (-1 if the host doesn't expose one, as in most VMs)
+int openDTLBMissCounter()
+{
+    perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = PERF_TYPE_HW_CACHE;
+    attributes.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attributes.disabled = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    return syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+}
+
+// bytes of this process's memory that are currently backed by transparent huge pages
+double_word getHugePageBytes()
+{
+    FILE *file_ptr = fopen("/proc/self/smaps_rollup", "r");
+    if (file_ptr == NULL) { return 0; }
+
+    char line[128];
+    double_word kilobytes, total = 0;
+    while (fgets(line, sizeof(line), file_ptr) != NULL)
+    {
+        if (sscanf(line, "AnonHugePages: %llu kB", &kilobytes) == 1 || sscanf(line, "ShmemPmdMapped: %llu kB", &kilobytes) == 1)
+        {
+            total += kilobytes * 1024;
+        }
+    }
+    fclose(file_ptr);
+    return total;
+}
+
+// Random word loads and stores over an array filling the start of global data, backed by regular and then huge host pages
+void benchmarkHugePages(memory_backend_t backend = MAPPED, word array_size = 0x20000000, double_word accesses = 0x2000000)
+{
+    const AddressRange<word> global_data_address_range = {0x40000800, 0x800007FF};
+    const word array_start = global_data_address_range.start;
+    const word array_words = array_size / sizeof(word);
+    const char *backend_names[] = {"HASHED", "PAGED", "MAPPED", "GUARDED"};
+
+    printf("Huge page benchmark: %s memory, %u MiB array, %llu random accesses (1 in 4 is a store)\n",
+           backend_names[backend], array_size >> 20, accesses);
+    printf("%-13s  %12s  %12s  %10s  %16s  %14s\n", "Host pages", "Populate (s)", "Accesses (s)", "ns/access",
+           "dTLB load misses", "Huge page MiB");
+
+    for (bool huge : {false, true})
+    {
+        double_word huge_bytes_before = getHugePageBytes();
+        Memory<word> memory(backend);
+        // regular pages are requested explicitly too, since hosts may use huge pages without being asked
+        bool advised = memory.setHugePages(global_data_address_range, huge);
+
+        auto start = std::chrono::steady_clock::now();
+        memory.fill(array_start, 1, array_size);  // commits every page of the array
+        double populate_seconds = secondsSince(start);
+        double_word huge_bytes = getHugePageBytes() - huge_bytes_before;
+
+        int tlb_counter = openDTLBMissCounter();
+        if (tlb_counter != -1)
+        {
+            ioctl(tlb_counter, PERF_EVENT_IOC_RESET, 0);
+            ioctl(tlb_counter, PERF_EVENT_IOC_ENABLE, 0);
+        }
+
+        double_word random = 0x2545F4914F6CDD1D;
+        volatile word loaded;  // keeps the loads from being optimized away
+        start = std::chrono::steady_clock::now();
+        for (double_word i = 0; i < accesses; i++)
+        {
+            random = random * 6364136223846793005ULL + 1442695040888963407ULL;  // 64-bit LCG, using its high bits
+            word address = array_start + (word) ((random >> 32) % array_words) * sizeof(word);
+            if ((i & 3) == 3) { memory.store<word>(address, (word) i); }
+            else { loaded = memory.load<word>(address); }
+        }
+        double access_seconds = secondsSince(start);
+        (void) loaded;
+
+        char tlb_misses[32] = "unavailable";
+        if (tlb_counter != -1)
+        {
+            double_word count = 0;
+            ioctl(tlb_counter, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(tlb_counter, &count, sizeof(count)) == sizeof(count)) { snprintf(tlb_misses, sizeof(tlb_misses), "%llu", count); }
+            close(tlb_counter);
+        }
+
+        char label[32];
+        snprintf(label, sizeof(label), "%s%s", huge ? "huge" : "regular", advised ? "" : " (n/a)");
+        printf("%-13s  %12.3f  %12.3f  %10.1f  %16s  %14llu\n", label, populate_seconds, access_seconds,
+               access_seconds * 1e9 / accesses, tlb_misses, huge_bytes >> 20);
+    }
+}
+
+// Loads and stores of a 64-bit guest with its heap at the bottom of the address space and its stack at the top,
+// which are as far apart as PAGED memory's page tables can be (the default sizes fit in host caches but not in the TLB,
+// so most of the time goes to finding pages)
+template <endian_t endian = LITTLE>
+void benchmarkPageTable(double_word heap_size = 0x100000, double_word stack_size = 0x40000, double_word accesses = 0x2000000)
+{
+    const double_word heap_start = 0x40000800;  // global data
+    const double_word stack_top = 0xFFFFFFFFFFFFF800;  // just below a 64-bit interrupt handler
+    Memory<double_word, endian> memory(PAGED);
+
+    printf("Page table benchmark: %llu MiB heap, %llu MiB stack, %llu accesses each (1 in 4 is a store)\n",
+           heap_size >> 20, stack_size >> 20, accesses);
+    printf("%-32s  %10s  %10s\n", "Pattern", "Time (s)", "ns/access");
+    auto report = [&](const char *pattern, double seconds, double_word count)
+    {
+        printf("%-32s  %10.3f  %10.1f\n", pattern, seconds, seconds * 1e9 / count);
+    };
+
+    // first touches allocate every page and page table
+    auto start = std::chrono::steady_clock::now();
+    memory.fill(heap_start, 1, heap_size);
+    report("Populate heap", secondsSince(start), heap_size / sizeof(double_word));
+    start = std::chrono::steady_clock::now();
+    for (double_word address = stack_top - sizeof(double_word); address >= stack_top - stack_size; address -= sizeof(double_word))
+    {
+        memory.template store<double_word>(address, address);  // pushes
+    }
+    report("Populate stack (pushes)", secondsSince(start), stack_size / sizeof(double_word));
+
+    double_word random = 0x2545F4914F6CDD1D;
+    volatile double_word loaded;  // keeps the loads from being optimized away
+    for (int pattern = 0; pattern < 3; pattern++)
+    {
+        start = std::chrono::steady_clock::now();
+        for (double_word i = 0; i < accesses; i++)
+        {
+            random = random * 6364136223846793005ULL + 1442695040888963407ULL;  // 64-bit LCG, using its high bits
+            double_word heap_address = heap_start + ((random >> 32) % (heap_size / sizeof(double_word))) * sizeof(double_word);
+            double_word stack_address = stack_top - (((random >> 40) % (stack_size / sizeof(double_word))) + 1) * sizeof(double_word);
+            double_word address = (pattern == 0) ? heap_address : (pattern == 1) ? stack_address : (i & 1) ? heap_address : stack_address;
+            if ((i & 3) == 3) { memory.template store<double_word>(address, i); }
+            else { loaded = memory.template load<double_word>(address); }
+        }
+        const char *pattern_names[] = {"Random heap", "Random stack", "Random heap and stack, alternating"};
+        report(pattern_names[pattern], secondsSince(start), accesses);
+    }
+    (void) loaded;
+
+    TLBStatistics tlb_statistics = memory.getTLBStatistics();
+    printf("TLB misses: %llu reads, %llu writes\n", tlb_statistics.read_misses, tlb_statistics.write_misses);
+}
+
+// Runs Programs/benchmark.s on a CPU with the M extension, with code promoted to each tier in turn (false if a tier
+// leaves different primes or a different sieve than the interpreter)
+template <template <endian_t> class CPU, typename word_size, endian_t endian>
+bool benchmarkJITOn(const char *cpu_name, memory_backend_t backend)
+{
+    const AddressRange<word_size> sieve = {0x40010000, 0x40010000 + 8192 - 1};  // as benchmark.s lays it out
+    const byte s3 = 19, s4 = 20;  // primes over all rounds, and in the last round
+    // the benchmark is assembled as the CPU's main program, but into its own binary
+    if (!assemble<word_size>("./Programs/bootloader.s", endian) || !assemble<word_size>("./Programs/benchmark.s", endian, 0x40000000) ||
+        !assemble<word_size>("./Programs/interrupt_handler.s", endian))
+    {
+        return false;
+    }
+
+    bool agree = true;
+    word_size interpreter_primes = 0, interpreter_last_primes = 0;
+    double_word interpreter_checksum = 0;
+    const char *tier_names[NUM_TIERS] = {"interpreter", "predecoded", "native"};
+    for (int top_tier = INTERPRETER; top_tier < NUM_TIERS; top_tier++)
+    {
+        M<word_size, endian> M_ext;
+        ExtensionList<word_size, endian> extensions = {&M_ext};
+        CPU<endian> cpu(extensions, backend);
+        cpu.setProgramFile("./Programs/benchmark");
+        TierSettings tiers = DEFAULT_TIERS;
+        tiers.predecoded = top_tier >= PREDECODED;
+        tiers.native = top_tier >= NATIVE;
+        if (!cpu.setTiers(tiers))
+        {
+            printf("%-8s  %-11s  unavailable on this host\n", cpu_name, tier_names[top_tier]);
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        cpu.start();
+        double seconds = secondsSince(start);
+        double_word instructions = cpu.getInstructionCount();
+        printf("%-8s  %-11s  %14llu  %10.3f  %10.1f\n", cpu_name, tier_names[top_tier], instructions, seconds,
+               instructions / seconds / 1e6);
+
+        // a faster tier is only worth timing if it computes what the interpreter does
+        word_size primes = cpu.getRegister(s3), last_primes = cpu.getRegister(s4);
+        double_word checksum = cpu.checksumMemory(sieve);
+        if (top_tier == INTERPRETER)
+        {
+            interpreter_primes = primes;
+            interpreter_last_primes = last_primes;
+            interpreter_checksum = checksum;
+        }
+        else if (primes != interpreter_primes || last_primes != interpreter_last_primes || checksum != interpreter_checksum)
+        {
+            printf("ERROR: %s %s tier disagrees with the interpreter: s3 = %llu (expected %llu), s4 = %llu (expected %llu), "
+                   "sieve checksum = %016llX (expected %016llX)\n", cpu_name, tier_names[top_tier], (double_word) primes,
+                   (double_word) interpreter_primes, (double_word) last_primes, (double_word) interpreter_last_primes,
+                   checksum, interpreter_checksum);
+            agree = false;
+        }
+    }
+    return agree;
+}
+
+// Guest instructions per second of the interpreter, predecoded blocks, and the JIT, on 32-bit and 64-bit CPUs (false if
+// any tier's results differ from the interpreter's)
+template <endian_t endian = LITTLE>
+bool benchmarkJIT(memory_backend_t backend = MAPPED)
+{
+    const char *backend_names[] = {"HASHED", "PAGED", "MAPPED", "GUARDED"};
+    printf("JIT benchmark: Programs/benchmark.s, %s memory\n", backend_names[backend]);
+    printf("%-8s  %-11s  %14s  %10s  %10s\n", "CPU", "Top tier", "Instructions", "Time (s)", "MIPS");
+    bool agree = benchmarkJITOn<RV32I, word, endian>("RV32I+M", backend);
+    agree = benchmarkJITOn<RV64I, double_word, endian>("RV64I+M", backend) && agree;
+    return agree;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,20 @@
+#ifndef BYTE_SWAP_H
+#define BYTE_SWAP_H
+
+#include "DataTypes.h"
+
+// Reverses the byte order of data (utility for Memory's whole-word accesses)
+template <typename word_size = word>
+word_size byteSwap(word_size data)
+{
+    if constexpr (sizeof(word_size) == 2) { return __builtin_bswap16(data); }
+    else if constexpr (sizeof(word_size) == 4) { return __builtin_bswap32(data); }
+    else if constexpr (sizeof(word_size) == 8) { return __builtin_bswap64(data); }
+    else if constexpr (sizeof(word_size) == 16)
+    {
+        return (((word_size) __builtin_bswap64((double_word) data)) << 64) | __builtin_bswap64((double_word) (data >> 64));
+    }
+    else { return data; }  // a single byte has no order to reverse
+}
+
+#endif
\ No newline at end of file
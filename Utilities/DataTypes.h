@@ -86,7 +86,7 @@ typedef struct
 {
     bool valid = false;
     byte opcode = 0;
-    word imm = 0;
+    double_word imm = 0;  // sign extended to 64 bits when decoded, so casting it to word_size gives it at any width
     byte rd = 0;
     byte rs1 = 0;
     byte rs2 = 0;
@@ -3,6 +3,12 @@
 
 #include "DataTypes.h"
 
+// sign extends an immediate whose sign is at sign_bit to 64 bits (utility for getDecodedInstructionFromFormat())
+double_word signExtendImmediate(word immediate, byte sign_bit)
+{
+    return (double_word) (s_double_word) ((s_word) (immediate << (31 - sign_bit)) >> (31 - sign_bit));
+}
+
 // returns decoded instruction based on its format (utility for decode())
 dec_instr_t getDecodedInstructionFromFormat(word raw_instruction, instr_format_t format)
 {
@@ -23,7 +29,7 @@ dec_instr_t getDecodedInstructionFromFormat(word raw_instruction, instr_format_t
         case I:
             decoded_instruction.valid = true;
             decoded_instruction.opcode = (byte) (raw_instruction & 127);
-            decoded_instruction.imm = (word) ((raw_instruction >> 20) & 4095);
+            decoded_instruction.imm = signExtendImmediate((raw_instruction >> 20) & 4095, 11);
             decoded_instruction.rd = (byte) ((raw_instruction >> 7) & 31);
             decoded_instruction.rs1 = (byte) ((raw_instruction >> 15) & 31);
             decoded_instruction.rs2 = (byte) 0;
@@ -34,7 +40,7 @@ dec_instr_t getDecodedInstructionFromFormat(word raw_instruction, instr_format_t
         case S:
             decoded_instruction.valid = true;
             decoded_instruction.opcode = (byte) (raw_instruction & 127);
-            decoded_instruction.imm = (word) (((raw_instruction >> 20) & 4064) | ((raw_instruction >> 7) & 31));
+            decoded_instruction.imm = signExtendImmediate(((raw_instruction >> 20) & 4064) | ((raw_instruction >> 7) & 31), 11);
             decoded_instruction.rd = (byte) 0;
             decoded_instruction.rs1 = (byte) ((raw_instruction >> 15) & 31);
             decoded_instruction.rs2 = (byte) ((raw_instruction >> 20) & 31);
@@ -45,8 +51,8 @@ dec_instr_t getDecodedInstructionFromFormat(word raw_instruction, instr_format_t
         case B:
             decoded_instruction.valid = true;
             decoded_instruction.opcode = (byte) (raw_instruction & 127);
-            decoded_instruction.imm = (word) (((raw_instruction >> 19) & 4096) | ((raw_instruction << 4) & 2048) |
-                                              ((raw_instruction >> 20) & 2016) | ((raw_instruction >> 7) & 30));
+            decoded_instruction.imm = signExtendImmediate(((raw_instruction >> 19) & 4096) | ((raw_instruction << 4) & 2048) |
+                                                          ((raw_instruction >> 20) & 2016) | ((raw_instruction >> 7) & 30), 12);
             decoded_instruction.rd = (byte) 0;
             decoded_instruction.rs1 = (byte) ((raw_instruction >> 15) & 31);
             decoded_instruction.rs2 = (byte) ((raw_instruction >> 20) & 31);
@@ -57,7 +63,7 @@ dec_instr_t getDecodedInstructionFromFormat(word raw_instruction, instr_format_t
         case U:
             decoded_instruction.valid = true;
             decoded_instruction.opcode = (byte) (raw_instruction & 127);
-            decoded_instruction.imm = (word) (raw_instruction & 4294963200u);
+            decoded_instruction.imm = signExtendImmediate(raw_instruction & 4294963200u, 31);
             decoded_instruction.rd = (byte) ((raw_instruction >> 7) & 31);
             decoded_instruction.rs1 = (byte) 0;
             decoded_instruction.rs2 = (byte) 0;
@@ -68,8 +74,8 @@ dec_instr_t getDecodedInstructionFromFormat(word raw_instruction, instr_format_t
         case J:
             decoded_instruction.valid = true;
             decoded_instruction.opcode = (byte) (raw_instruction & 127);
-            decoded_instruction.imm = (word) (((raw_instruction >> 11) & 1048576) | (raw_instruction & 1044480) |
-                                              ((raw_instruction >> 9) & 2048) | ((raw_instruction >> 20) & 2046));
+            decoded_instruction.imm = signExtendImmediate(((raw_instruction >> 11) & 1048576) | (raw_instruction & 1044480) |
+                                                          ((raw_instruction >> 9) & 2048) | ((raw_instruction >> 20) & 2046), 20);
             decoded_instruction.rd = (byte) ((raw_instruction >> 7) & 31);
             decoded_instruction.rs1 = (byte) 0;
             decoded_instruction.rs2 = (byte) 0;
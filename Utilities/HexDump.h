@@ -62,8 +62,8 @@ void hexDump(std::string filename, word start = 0, word end = -1)
 }
 
 // hex dump from a memory object
-template <typename word_size = word>
-void hexDump(Memory<word_size> &mem, word_size start, word_size end)
+template <typename word_size = word, endian_t endian = LITTLE>
+void hexDump(const Memory<word_size, endian> &mem, word_size start, word_size end)
 {
     if (start > end) 
     {
@@ -75,6 +75,7 @@ void hexDump(Memory<word_size> &mem, word_size start, word_size end)
 
     word_size byte_num = new_start;  // byte number (printed for every line / 16 bytes)
     byte curr_byte;  // current byte being read
+    byte line[16];  // bytes of the line being printed (peeked so dumping never allocates memory)
     std::string ascii = "................";  // ascii representation of line of bytes
     bool print_byte;  // flag to either print byte or dashes
 
@@ -82,7 +83,8 @@ void hexDump(Memory<word_size> &mem, word_size start, word_size end)
     {
         print_byte = byte_num >= start && byte_num <= end;
 
-        curr_byte = mem.getByte(byte_num);
+        if (byte_num % 16 == 0) { mem.peekRange(byte_num, line, 16); }
+        curr_byte = line[byte_num % 16];
 
         if (byte_num % 16 == 0)
         { 
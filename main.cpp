@@ -1,18 +1,29 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "RISC-V_Emulator.h"
 
-int main()
+template <endian_t endian32, endian_t endian64>
+int run(memory_backend_t memory32, memory_backend_t memory64, TierSettings tiers)
 {
-    M<word> M_ext32;
-    M<double_word> M_ext64;
-    ExtensionList<word> extensions32 = {&M_ext32};
-    ExtensionList<double_word> extensions64 = {&M_ext64};
-    endian_t endian32 = BIG, endian64 = LITTLE;
-    RV32I cpu32I(endian32, extensions32);
-    RV32E cpu32E;
-    RV64I cpu64I(endian64, extensions64);
-    RV64E cpu64E;
+    // RV32IM and RV64IM are composed when they're compiled (a base ISA given an ExtensionList picks them at runtime instead)
+    Core<RV32I<endian32>, M<word, endian32>> cpu32I(memory32);
+    RV32E<> cpu32E;
+    Core<RV64I<endian64>, M<double_word, endian64>> cpu64I(memory64);
+    RV64E<> cpu64E;
+
+    bool tiers_available = cpu32I.setTiers(tiers);
+    tiers_available = cpu32E.setTiers(tiers) && tiers_available;
+    tiers_available = cpu64I.setTiers(tiers) && tiers_available;
+    tiers_available = cpu64E.setTiers(tiers) && tiers_available;
+    if (!tiers_available) { printf("The native tier needs an x86-64 host and the predecoded tier, so hot blocks won't be translated\n"); }
 
+    // cpu32I.setHugePages(true);
+    // cpu32I.setJIT(true);
+    // cpu32I.setStatisticsFile("./memory_statistics.txt", true);
+    // benchmarkHugePages();
+    // benchmarkPageTable();
+    // benchmarkJIT();
     // assemble();
     // hexDump("./Programs/interrupt_handler");
     // assemble("./Programs/bootloader.s", LITTLE);
@@ -21,4 +32,52 @@ int main()
     // if(assemble<double_word>(endian64)) { cpu64I.start(); }
     // if(assemble<double_word>()) { cpu64E.start(); }
     return 0;
+}
+
+// reads the execution tier options into tiers (returns false for an option it doesn't know)
+bool parseTierOptions(int argc, char *argv[], TierSettings &tiers)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--tiers=", 8) == 0)
+        {
+            // the interpreter always runs what the other tiers can't, so it may be left out of the list
+            tiers.predecoded = false;
+            tiers.native = false;
+            std::string list = std::string(argv[i] + 8) + ",";
+            for (std::size_t start = 0, end = list.find(','); end != std::string::npos; start = end + 1, end = list.find(',', start))
+            {
+                std::string tier = list.substr(start, end - start);
+                if (tier == "predecoded") { tiers.predecoded = true; }
+                else if (tier == "native") { tiers.native = true; }
+                else if (tier != "interpreter") { return false; }
+            }
+        }
+        else if (strncmp(argv[i], "--predecode-threshold=", 22) == 0) { tiers.predecode_threshold = strtoul(argv[i] + 22, NULL, 0); }
+        else if (strncmp(argv[i], "--native-threshold=", 19) == 0) { tiers.native_threshold = strtoul(argv[i] + 19, NULL, 0); }
+        else if (strcmp(argv[i], "--report-tiers") == 0) { tiers.report = true; }
+        else { return false; }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    endian_t endian32 = BIG, endian64 = LITTLE;
+    memory_backend_t memory32 = MAPPED, memory64 = PAGED;
+
+    TierSettings tiers = DEFAULT_TIERS;
+    if (!parseTierOptions(argc, argv, tiers))
+    {
+        printf("Usage: %s [--tiers=interpreter[,predecoded[,native]]] [--predecode-threshold=N] [--native-threshold=N] [--report-tiers]\n",
+               argv[0]);
+        return 1;
+    }
+
+    // byte order is compiled into the CPUs, so the runtime choice picks which pair of them to run
+    if(endian32 == LITTLE)
+    {
+        return (endian64 == LITTLE) ? run<LITTLE, LITTLE>(memory32, memory64, tiers) : run<LITTLE, BIG>(memory32, memory64, tiers);
+    }
+    return (endian64 == LITTLE) ? run<BIG, LITTLE>(memory32, memory64, tiers) : run<BIG, BIG>(memory32, memory64, tiers);
 }
\ No newline at end of file